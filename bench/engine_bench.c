@@ -0,0 +1,261 @@
+/**
+ * @file engine_bench.c
+ *
+ * @brief
+ *      Benchmark that runs the find/replace engine in-process (through libfindreplace) on synthetic corpora
+ *      and reports its throughput as JSON.
+ *
+ * @note
+ *      Usage: ./bin/engine_bench [largest corpus size, e.g. 10G (default 256M)]
+ *      Corpora of 1 MB, 16 MB, 256 MB, ... up to the largest size are generated for every case: literal,
+ *      prefix and suffix searches, sparse and dense matches, short and long lines, short and long
+ *      literal patterns, and case-insensitive searches (i flag). A corpus is made of one block of at most BLOCK_LIMIT bytes that is fed to the
+ *      engine again and again, so its size is not limited by the memory (and is rounded down to a whole
+ *      number of blocks).
+ * @note
+ *      Every case prints one JSON object per line with its throughput (MB/s, matches/s), the reference cycles
+ *      per byte of the time-stamp counter (null where there is none) and the peak RSS of the process so far.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "libfindreplace.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC
+#endif
+
+#define MIN_SIZE (1UL << 20)
+#define DEFAULT_MAX_SIZE (1UL << 28)
+#define BLOCK_LIMIT (1UL << 26)
+
+//Sparse cases plant a match every 64 KB or so, and dense cases every 64 bytes or so
+#define SPARSE_DISTANCE (1 << 16)
+#define DENSE_DISTANCE 64
+
+/*
+BenchCase describes one synthetic corpus and its search.
+mode = 0: literal search, mode = 1: prefix search, mode = 2: suffix search (see fr_pattern).
+Filler words only use the letters a to h, and every match is planted as a word of its own made of w to z, so the
+number of matches is known, whether the search ignores case or not.
+*/
+typedef struct {
+    int mode;
+    size_t lineLen, matchDistance, patternLen;
+    bool ignoreCase;
+} BenchCase;
+
+static const char *modeNames[] = {"literal", "prefix", "suffix"};
+
+static const BenchCase cases[] = {
+    {0, 80, SPARSE_DISTANCE, 3, false}, {0, 80, DENSE_DISTANCE, 3, false}, {0, 80, SPARSE_DISTANCE, 16, false},
+    {0, 80, DENSE_DISTANCE, 16, false}, {0, 8192, SPARSE_DISTANCE, 3, false}, {0, 8192, DENSE_DISTANCE, 3, false},
+    {0, 8192, SPARSE_DISTANCE, 16, false}, {0, 8192, DENSE_DISTANCE, 16, false}, {0, 80, SPARSE_DISTANCE, 48, false},
+    {0, 8192, DENSE_DISTANCE, 48, false}, {1, 80, SPARSE_DISTANCE, 2, false}, {1, 80, DENSE_DISTANCE, 2, false},
+    {1, 8192, DENSE_DISTANCE, 2, false}, {2, 80, SPARSE_DISTANCE, 2, false}, {2, 80, DENSE_DISTANCE, 2, false},
+    {2, 8192, DENSE_DISTANCE, 2, false}, {0, 80, SPARSE_DISTANCE, 3, true}, {0, 80, DENSE_DISTANCE, 16, true},
+    {0, 8192, SPARSE_DISTANCE, 48, true}, {1, 80, DENSE_DISTANCE, 2, true},
+};
+
+
+/**
+ * @brief
+ *      Obtains the current time in seconds.
+ */
+static double now(){
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief
+ *      Parses a size such as 64M or 10G.
+ *
+ * @return
+ *      Size in bytes.
+ */
+static size_t parseSize(const char *size){
+    char *unit;
+    size_t bytes = strtoul(size, &unit, 10);
+    if(*unit == 'K' || *unit == 'k') bytes <<= 10;
+    else if(*unit == 'M' || *unit == 'm') bytes <<= 20;
+    else if(*unit == 'G' || *unit == 'g') bytes <<= 30;
+    return bytes;
+}
+
+
+/**
+ * @brief
+ *      xorshift64 generator, so every run generates the same corpora.
+ */
+static unsigned long long nextRandom(unsigned long long *state){
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+
+/**
+ * @brief
+ *      Writes the search text of a case (the planted word of a literal search, the '*' of a prefix/suffix).
+ */
+static void searchText(const BenchCase *bench, char *search){
+    size_t len = 0;
+
+    if(bench->mode == 2) search[len++] = '*';
+    for(size_t i = 0; i < bench->patternLen; i++) search[len++] = "wxyz"[i % 4];
+    if(bench->mode == 1) search[len++] = '*';
+    search[len] = '\0';
+}
+
+
+/**
+ * @brief
+ *      Generates the block of a corpus, which ends with a '\n'.
+ *
+ * @param matches
+ *      Pointer that is set to the number of matches planted in the block.
+ *
+ * @return
+ *      Block of blockLen bytes, or NULL if it couldn't be allocated.
+ */
+static char *generateBlock(const BenchCase *bench, size_t blockLen, size_t *matches){
+    char *texts = malloc(blockLen);
+    unsigned long long state = 0x9E3779B97F4A7C15ULL;
+    size_t pos = 0, lineStart = 0;
+
+    if(!texts) return NULL;
+    *matches = 0;
+
+    while(pos + bench->patternLen + 16 < blockLen){
+        //Average word of 5.5 bytes with its space, so a word is planted once per matchDistance bytes or so.
+        bool planted = nextRandom(&state) % (bench->matchDistance * 2 / 11) == 0;
+        size_t fillerLen = 1 + nextRandom(&state) % 8;
+
+        if(planted){
+            if(bench->mode == 2) for(size_t i = 0; i < fillerLen; i++) texts[pos++] = 'a' + nextRandom(&state) % 8;
+            for(size_t i = 0; i < bench->patternLen; i++) texts[pos++] = "wxyz"[i % 4];
+            if(bench->mode == 1) for(size_t i = 0; i < fillerLen; i++) texts[pos++] = 'a' + nextRandom(&state) % 8;
+            (*matches)++;
+        }
+        else for(size_t i = 0; i < fillerLen; i++) texts[pos++] = 'a' + nextRandom(&state) % 8;
+
+        bool lineEnd = pos + 1 - lineStart >= bench->lineLen;
+        texts[pos++] = lineEnd ? '\n' : ' ';
+        if(lineEnd) lineStart = pos;
+    }
+
+    //The rest of the block is padded with filler, so the block can be fed again and again.
+    while(pos < blockLen - 1) texts[pos++] = 'a';
+    texts[pos] = '\n';
+    return texts;
+}
+
+
+//Output of the engine, which is only counted.
+static bool countOutput(const char *texts, size_t textsLen, void *user){
+    (void)texts;
+    *(size_t *)user += textsLen;
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Runs a case on a corpus of size bytes and prints its results as a JSON object.
+ *
+ * @return
+ *      False if the case couldn't be run.
+ */
+static bool runCase(const BenchCase *bench, size_t size, bool first){
+    char search[64], replace[64];
+    size_t blockLen = size < BLOCK_LIMIT ? size : BLOCK_LIMIT, blockMatches, outputLen = 0;
+
+    //A corpus is a whole number of blocks, so its matches are known.
+    size -= size % blockLen;
+
+    searchText(bench, search);
+    memset(replace, 'R', bench->patternLen + 1);
+    replace[bench->patternLen + 1] = '\0';
+
+    fr_options options = {.search = search, .replace = replace, .wildcard = bench->mode != 0,
+        .ignoreCase = bench->ignoreCase};
+    fr_pattern *pattern;
+    char *texts = generateBlock(bench, blockLen, &blockMatches);
+    if(!texts || fr_compile(&options, &pattern) != FR_OK){
+        free(texts);
+        return false;
+    }
+
+    fr_context *context = fr_context_new(pattern, countOutput, &outputLen);
+    size_t fed = 0, matches = 0;
+    int error = context ? FR_OK : FR_OUT_OF_MEMORY;
+
+    double started = now();
+#ifdef HAVE_TSC
+    unsigned long long startCycles = __rdtsc();
+#endif
+    while(!error && fed < size){
+        error = fr_apply_buffer(context, texts, blockLen, fed + blockLen == size);
+        matches += blockMatches;
+        fed += blockLen;
+    }
+#ifdef HAVE_TSC
+    double cycles = __rdtsc() - startCycles;
+#endif
+    double seconds = now() - started;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    printf("%s{\"mode\": \"%s\", \"search\": \"%s\", \"patternLen\": %zu, \"lineLen\": %zu, \"matchDistance\": %zu, ",
+        first ? "" : ",\n", modeNames[bench->mode], search, bench->patternLen, bench->lineLen, bench->matchDistance);
+    printf("\"ignoreCase\": %s, ", bench->ignoreCase ? "true" : "false");
+    printf("\"bytes\": %zu, \"outputBytes\": %zu, \"matches\": %zu, \"seconds\": %.6f, \"mbPerSec\": %.1f, ", size,
+        outputLen, matches, seconds, size / seconds / 1e6);
+    printf("\"matchesPerSec\": %.0f, ", matches / seconds);
+#ifdef HAVE_TSC
+    printf("\"cyclesPerByte\": %.3f, ", cycles / size);
+#else
+    printf("\"cyclesPerByte\": null, ");
+#endif
+    printf("\"peakRssKb\": %ld, \"error\": %d}", usage.ru_maxrss, error);
+    fflush(stdout);
+
+    fr_context_free(context);
+    fr_free(pattern);
+    free(texts);
+    return !error;
+}
+
+
+int main(int argc, char *argv[]){
+    size_t maxSize = argc > 1 ? parseSize(argv[1]) : DEFAULT_MAX_SIZE;
+    bool first = true, failed = false;
+
+    if(maxSize < MIN_SIZE) maxSize = MIN_SIZE;
+
+    printf("[\n");
+    for(size_t size = MIN_SIZE; ; size *= 16){
+        if(size > maxSize) size = maxSize;
+
+        for(size_t c = 0; c < sizeof(cases) / sizeof(*cases); c++){
+            if(!runCase(cases + c, size, first)){
+                fprintf(stderr, "case %zu failed on %zu bytes\n", c, size);
+                failed = true;
+            }
+            first = false;
+        }
+        if(size == maxSize) break;
+    }
+    printf("\n]\n");
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
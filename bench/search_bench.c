@@ -0,0 +1,187 @@
+/**
+ * @file search_bench.c
+ *
+ * @brief
+ *      Microbenchmark that compares the search kernel with glibc strstr on the tests.in.orig corpora, and the
+ *      newline kernel with a memchr call per line.
+ *
+ * @note
+ *      Usage: ./bin/search_bench [corpus size, e.g. 256M or 1G (default)]
+ *      Every corpus is repeated until it reaches the requested size. Both searches count every (possibly
+ *      overlapping) occurrence of each pattern, so the match counts must agree. Patterns of TWO_WAY_MIN bytes
+ *      or more go through the Two-Way search. The "(newlines)" row of a
+ *      corpus counts its lines.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+
+#include "SearchKernel.h"
+
+#define CORPUS_DIR "tests.in.orig"
+#define DEFAULT_SIZE (1UL << 30)
+
+static const char *corpora[] = {"turing.txt", "unix.txt", "random.txt", "punctuation.txt", "camelSpace.txt", "ha.txt", "oneword.txt"};
+static const char *patterns[] = {"e", "ha", "the", "machine", "Manchester", "no such pattern",
+    "considered to be the father of theoretical", "https://www.example.com/no/such/page/index.html",
+    "hahahahahahahahahahahahahahahahahahahahahahahahaha"};
+
+
+/**
+ * @brief
+ *      Obtains the current time in seconds.
+ */
+static double now(){
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief
+ *      Parses a size such as 64M or 1G.
+ *
+ * @return
+ *      Size in bytes.
+ */
+static size_t parseSize(const char *size){
+    char *unit;
+    size_t bytes = strtoul(size, &unit, 10);
+    if(*unit == 'K' || *unit == 'k') bytes <<= 10;
+    else if(*unit == 'M' || *unit == 'm') bytes <<= 20;
+    else if(*unit == 'G' || *unit == 'g') bytes <<= 30;
+    return bytes;
+}
+
+
+/**
+ * @brief
+ *      Reads a corpus and repeats it until it has size bytes.
+ *
+ * @return
+ *      Null-terminated corpus, or NULL if it couldn't be read.
+ */
+static char *loadCorpus(const char *name, size_t size){
+    char path[256];
+    sprintf(path, "%s/%s", CORPUS_DIR, name);
+
+    FILE *file = fopen(path, "r");
+    if(!file) return NULL;
+
+    char *texts = malloc(size + 1);
+    size_t fileLen = texts ? fread(texts, 1, size, file) : 0;
+    fclose(file);
+    if(!fileLen){
+        free(texts);
+        return NULL;
+    }
+
+    for(size_t filled = fileLen; filled < size; filled += fileLen)
+        memcpy(texts + filled, texts, filled + fileLen <= size ? fileLen : size - filled);
+    texts[size] = '\0';
+    return texts;
+}
+
+
+/**
+ * @brief
+ *      Counts the occurrences of pattern with strstr, restarting one character after every match.
+ */
+static size_t countWithStrstr(const char *texts, const char *pattern){
+    size_t count = 0;
+    for(const char *found = texts; (found = strstr(found, pattern)); found++) count++;
+    return count;
+}
+
+
+/**
+ * @brief
+ *      Counts the occurrences of pattern with the search kernel of its length (or the Two-Way search of a long
+ *      pattern), through a MatchCursor as the engine does.
+ */
+static size_t countWithKernel(const char *texts, size_t textsLen, const char *pattern){
+    size_t patternLen = strlen(pattern), count = 0;
+    PatternTable table;
+    MatchCursor matches;
+    const char *found;
+
+    if(patternLen >= TWO_WAY_MIN) buildPatternTable(pattern, patternLen, false, &table);
+    initMatchCursor(&matches, texts, textsLen, pattern, patternLen, patternKernel(patternLen), &table);
+    for(found = nextMatch(&matches, 0); found; found = nextMatch(&matches, found - texts + 1)) count++;
+    return count;
+}
+
+
+/**
+ * @brief
+ *      Counts the '\n' with a memchr call per line, as a line-by-line reader does.
+ */
+static size_t countLinesWithMemchr(const char *texts, size_t textsLen){
+    const char *pos = texts, *end = texts + textsLen;
+    size_t count = 0;
+
+    while((pos = memchr(pos, '\n', end - pos))){
+        count++;
+        pos++;
+    }
+    return count;
+}
+
+
+/**
+ * @brief
+ *      Counts the '\n' with the newline kernel.
+ */
+static size_t countLinesWithKernel(const char *texts, size_t textsLen){
+    long long lines = LLONG_MAX;
+    skipNewlines(texts, textsLen, &lines);
+    return LLONG_MAX - lines;
+}
+
+
+int main(int argc, char *argv[]){
+    size_t size = argc > 1 ? parseSize(argv[1]) : DEFAULT_SIZE;
+    int mismatches = 0;
+
+    printf("search kernel: %s, corpus size: %zu bytes\n", searchKernelName(), size);
+    printf("%-16s %-16s %12s %14s %14s %8s\n", "corpus", "pattern", "matches", "strstr MB/s", "kernel MB/s", "speedup");
+
+    for(size_t c = 0; c < sizeof(corpora) / sizeof(*corpora); c++){
+        char *texts = loadCorpus(corpora[c], size);
+        if(!texts){
+            fprintf(stderr, "skipping %s: couldn't be read\n", corpora[c]);
+            continue;
+        }
+
+        for(size_t p = 0; p < sizeof(patterns) / sizeof(*patterns); p++){
+            double started = now();
+            size_t expected = countWithStrstr(texts, patterns[p]);
+            double strstrTime = now() - started;
+
+            started = now();
+            size_t actual = countWithKernel(texts, size, patterns[p]);
+            double kernelTime = now() - started;
+
+            printf("%-16s %-16s %12zu %14.1f %14.1f %7.2fx%s\n", corpora[c], patterns[p], actual, size / strstrTime / 1e6,
+                size / kernelTime / 1e6, strstrTime / kernelTime, actual == expected ? "" : "  MISMATCH");
+            mismatches += actual != expected;
+        }
+
+        double started = now();
+        size_t expected = countLinesWithMemchr(texts, size);
+        double memchrTime = now() - started;
+
+        started = now();
+        size_t actual = countLinesWithKernel(texts, size);
+        double kernelTime = now() - started;
+
+        printf("%-16s %-16s %12zu %14.1f %14.1f %7.2fx%s\n", corpora[c], "(newlines)", actual, size / memchrTime / 1e6,
+            size / kernelTime / 1e6, memchrTime / kernelTime, actual == expected ? "" : "  MISMATCH");
+        mismatches += actual != expected;
+        free(texts);
+    }
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
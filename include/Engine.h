@@ -0,0 +1,184 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "libfindreplace.h"
+#include "SearchKernel.h"
+#include "MultiPattern.h"
+#include "Regex.h"
+#include "WordGlob.h"
+#include "Unicode.h"
+
+//The input file is read in blocks of BLOCK_SIZE bytes, so lines may have any length
+#ifndef BLOCK_SIZE
+#define BLOCK_SIZE (1 << 16)
+#endif
+
+//Number of iovecs gathered before the output of a memory-mapped input file is written with writev
+#define IOV_BATCH 1024
+
+//Size of the page-aligned buffer of a BUFFER_OUTPUT target, which is written once it is full
+#ifndef WRITE_BUFFER_SIZE
+#define WRITE_BUFFER_SIZE (1 << 20)
+#endif
+
+//Kinds of output targets used by writeText()
+#define BUFFER_OUTPUT 0
+#define GATHER_OUTPUT 1
+#define MEMORY_OUTPUT 2
+#define PATCH_OUTPUT 3
+#define CALLBACK_OUTPUT 4
+
+//Counters of fr_stats, which are compiled out with -DNO_STATS (see statSeconds())
+#ifdef NO_STATS
+#define COUNT_STAT(stats, field, count) ((void)0)
+#define TIME_STAT(stats, field, statement) statement
+#else
+#define COUNT_STAT(stats, field, count) ((stats)->field += (count))
+#define TIME_STAT(stats, field, statement) do{ \
+        double statStarted = statSeconds(); \
+        statement; \
+        (stats)->field += statSeconds() - statStarted; \
+    } while(0)
+#endif
+
+//What the prefix/rules kernels do with the rest of a word that continues past the end of a block
+#define WORD_NONE 0
+#define WORD_SKIP 1
+#define WORD_COPY 2
+
+
+/*
+OutputTarget receives the texts printed by writeText() for one context.
+- BUFFER_OUTPUT: texts are copied into buffer, which is written to fd once it is full and by flushOutput().
+- GATHER_OUTPUT: texts are gathered in vecs and written to fd with writev by flushOutput().
+- MEMORY_OUTPUT: texts are copied into memory, which grows as needed.
+- PATCH_OUTPUT: texts are copied into the writable mapping patchBase at patchOffset, unless they are already there.
+- CALLBACK_OUTPUT: texts are gathered in vecs and handed to write by flushOutput().
+failed is set once a write fails (or memory can't grow), after which the texts are dropped. stats points to the
+counters of the context.
+*/
+typedef struct {
+    int kind;
+    bool failed;
+    struct iovec vecs[IOV_BATCH];
+    int vecCount;
+    int fd;
+    char *buffer;
+    size_t bufferLen;
+    char *memory;
+    size_t memoryLen, memoryCapacity;
+    char *patchBase;
+    size_t patchOffset;
+    fr_write_fn write;
+    void *user;
+    fr_stats *stats;
+} OutputTarget;
+
+//Find/replace function of a mode, called on every line (or beginning of a line) in range
+typedef size_t (*LineKernel)(fr_context *context, const char *curr_line, size_t lineLen, bool complete);
+
+/*
+SearchPlan holds everything fr_compile() derives from a search spec once, so that no kernel derives it per line.
+- kernel: find/replace function of the mode. A search text equal to its replacement text gets copyLine().
+- search: search kernel for the length of the search text (see patternKernel()), or its folded kernel with fold.
+- table: skip table and factorization of a search text of TWO_WAY_MIN bytes or more, which is searched with
+  searchTwoWay() instead.
+- words: characters that belong to a word, which bound the words of the prefix/suffix modes. wordClasses holds
+  its bytes for the AffixScanner of prefixWordsReplace() and suffixWordsReplace().
+- fold: the search text is folded and matches the texts whatever the case of their ASCII letters (i flag).
+- sameLength: every replacement has the same length as its search text, so the output has the same length as
+  the input and can be patched over it.
+- bytePatch: the output is the input with the replacement text overwritten at every match, whatever the lines
+  (an equal-length search text, without a line range or a '\n' before its last character). See patchBlock().
+*/
+typedef struct {
+    LineKernel kernel;
+    SearchKernel search;
+    PatternTable table;
+    WordSet words;
+    WordClasses wordClasses;
+    bool fold, sameLength, bytePatch;
+} SearchPlan;
+
+/*
+fr_pattern is a compiled search spec, read-only once fr_compile() returns.
+mode = 0: replaces all search texts, mode = 1: replaces all words with the prefix, mode = 2: replaces all words
+with the suffix, mode = 3: applies all rules, mode = 4: replaces all matches of the regex, mode = 5: replaces all
+words that match the glob.
+search never contains the '*' of the prefix/suffix modes. In the regex mode, search holds the literal texts every
+match begins with (possibly none), which are searched before the regex is run. In the glob mode, it holds the
+longest run of plain characters of the glob (possibly none), which is searched before a word is matched.
+*/
+struct fr_pattern {
+    int mode;
+    SearchPlan plan;
+    char *search, *replace;
+    size_t searchLen, replaceLen;
+    RuleSet rules;
+    Regex regex;
+    WordGlob glob;
+    int start_end_lines[2];
+};
+
+/*
+fr_context holds the state of one input fed to a pattern.
+lineStart and wordBefore describe the texts right before the next call of a prefix/rules kernel (see
+prefixReplace()), and lineStart whether the next call of the regex kernel begins a line (see regexReplace()). wordState tells how to finish a word whose prefix was already decided at the end of the last
+block, so a word longer than a block is never held in memory. carry keeps the undecided texts at the end of the last buffer of fr_apply_buffer().
+stats counts what the engine did with the context, without any lock since a context belongs to a single thread.
+regexCache holds the DFA states built by the regex mode, which is allocated by the first line and freed by
+releaseContext().
+*/
+struct fr_context {
+    const fr_pattern *pattern;
+    fr_stats stats;
+    OutputTarget output;
+    long long lineNum;
+    bool lineStart;
+    bool wordBefore;
+    int wordState;
+    char *carry;
+    size_t carryLen, carryCapacity;
+    RegexCache *regexCache;
+};
+
+
+//Functions declarations
+
+void initContext(fr_context *context, const fr_pattern *pattern, int kind);
+void releaseContext(fr_context *context);
+size_t suffixReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete);
+size_t prefixReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete);
+size_t prefixWordsReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete);
+size_t suffixWordsReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete);
+size_t updateStartIndex(const WordSet *words, const char *curr_line, size_t cursor, size_t startIndex);
+size_t updateEndIndex(const WordSet *words, const char *curr_line, size_t lineLen, size_t endIndex);
+size_t replace(fr_context *context, const char *curr_line, size_t lineLen, bool complete);
+size_t multiReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete);
+size_t regexReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete);
+size_t globReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete);
+size_t copyLine(fr_context *context, const char *curr_line, size_t lineLen, bool complete);
+size_t replaceLines(fr_context *context, const char *texts, size_t textsLen, bool complete);
+int streamReplace(fr_context *context, FILE *input, char **buffer, size_t *capacity, size_t *bytesRead);
+size_t patchBlock(fr_context *context, char *texts, size_t textsLen, bool complete);
+void patchedCopy(fr_context *context, const char *texts, size_t textsLen);
+void writeText(OutputTarget *target, const char *texts, size_t textsLen);
+bool flushOutput(OutputTarget *target);
+bool writeAll(int fd, const char *texts, size_t textsLen);
+char *allocWriteBuffer();
+double statSeconds();
+
+#endif
@@ -1,17 +1,40 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <stdbool.h>
-#include <unistd.h>
-#include <ctype.h>
-#include <limits.h>
+#include "Engine.h"
 
-//A line of the input file could have at most MAX_LINE + 1 characters (including the null terminator)
-#define MAX_LINE 200
+#include <fcntl.h>
+#include <time.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <getopt.h>
+#include <pthread.h>
 
-//A search/replace text could have at most MAX_TEXT_LEN + 1 characters (including the null terminator)
-#define MAX_TEXT_LEN 50
+//Chunks handed to the worker threads of the j flag have at least MIN_CHUNK_SIZE bytes
+#ifndef MIN_CHUNK_SIZE
+#define MIN_CHUNK_SIZE (1 << 20)
+#endif
 
+//The j flag uses at most MAX_THREADS worker threads
+#define MAX_THREADS 256
+
+//Codecs of compressed input/output files (see Compression.c)
+#define NO_CODEC 0
+#define GZIP_CODEC 1
+#define ZSTD_CODEC 2
+
+//Codec threads move the texts in blocks of CODEC_BLOCK_SIZE bytes, through pipes of CODEC_PIPE_SIZE bytes
+#define CODEC_BLOCK_SIZE (1 << 17)
+#define CODEC_PIPE_SIZE (1 << 20)
+
+//The line index of the x flag holds the offset of every LINE_INDEX_INTERVAL-th line, in a file named after the
+//input file with LINE_INDEX_SUFFIX appended (see LineIndex.c)
+#ifndef LINE_INDEX_INTERVAL
+#define LINE_INDEX_INTERVAL 1024
+#endif
+#define LINE_INDEX_SUFFIX ".lineidx"
+
+//Error codes 4 to 10, 12 and 13 have the same values as the error codes of libfindreplace (see libfindreplace.h),
+//and 11 is kept for its FR_OUT_OF_MEMORY
 #define MISSING_ARGUMENT 1
 #define INPUT_FILE_MISSING 2
 #define OUTPUT_FILE_UNWRITABLE 3
@@ -20,22 +43,108 @@
 #define L_ARGUMENT_INVALID 6
 #define WILDCARD_INVALID 7
 #define DUPLICATE_ARGUMENT 8
+#define RULES_FILE_INVALID 9
+#define OUTPUT_WRITE_FAILED 10
+#define INPUT_READ_FAILED 12
+#define REGEX_INVALID 13
+#define J_ARGUMENT_INVALID 14
+
+extern _Thread_local FILE *inputFile, *outputFile;
+extern _Thread_local char *inPlacePath;
+extern _Thread_local int inputCodec, outputCodec;
+extern int threadCount;
+
+/*
+BatchSummary counts the files of a batch.
+errorCounts[code] is the number of files that failed with that error code.
+*/
+typedef struct {
+    size_t fileCount, skippedCount, errorCounts[INPUT_READ_FAILED + 1];
+    size_t bytesRead;
+    int firstError;
+} BatchSummary;
+
+/*
+GlobList holds the globs of the I or X flag.
+*/
+typedef struct {
+    char **globs;
+    int count;
+} GlobList;
+
+extern GlobList includeGlobs, excludeGlobs;
+
+/*
+LineIndexHeader starts the file of a line index. fileSize and the modification time (mtimeSec, mtimeNsec) tell
+whether the index still describes the input file. It is followed by entryCount offsets.
+*/
+typedef struct {
+    char magic[8];
+    uint64_t interval, entryCount, fileSize;
+    int64_t mtimeSec, mtimeNsec;
+} LineIndexHeader;
+
+/*
+LineIndex is a line index read into memory. offsets[k] is the offset of line k * interval + 1 of the input file.
+*/
+typedef struct {
+    LineIndexHeader header;
+    uint64_t *offsets;
+} LineIndex;
+
+extern char *indexedInput;
+extern char *statsPath;
 
 
 //Functions declarations
 
-void getRemainingTexts(char *curr_line, char *startOfRemain, int lineLen);
-void suffixReplace(char *curr_line, char *suffix);
-void prefixReplace(char *curr_line, char *prefix);
-int updateStartIndex(char *curr_line, int startIndex);
-int updateEndIndex(char *curr_line, int lineLen, int endIndex);
-void replace(char *curr_line);
-void findReplace(int mode, int *start_end_lines);
+int findReplace(const fr_pattern *pattern, int threads, const char **inputPath, size_t *bytesRead);
+bool mappedFindReplace(const fr_pattern *pattern, const char *texts, size_t textsLen);
+bool rangeFindReplace(const fr_pattern *pattern, int inputFd, const char *texts, size_t textsLen, size_t offset,
+    const size_t *range);
+bool copyInputRange(int inputFd, const char *texts, size_t offset, size_t len, int outputFd);
+bool indexLineRange(const char *path, const struct stat *inputStat, const char *texts, size_t textsLen,
+    const int *start_end_lines, size_t *range);
+void scanLineRange(const char *texts, size_t textsLen, const int *start_end_lines, size_t *range);
+void addStats(fr_stats *total, const fr_stats *part);
+void recordStats(const fr_stats *stats);
+bool printStats(const char *jsonPath, const char *inputPath, size_t bytesRead, double seconds);
+bool parallelFindReplace(const fr_pattern *pattern, const char *texts, size_t textsLen, int threads);
+int streamFindReplace(const fr_pattern *pattern, size_t *bytesRead);
+void releaseStreamBuffer();
+int batchFindReplace(const fr_pattern *pattern, char **paths, int pathCount, const char *manifestPath, int treeWorkers,
+    size_t *bytesRead);
+void replaceBatchFile(char *path, const fr_pattern *pattern, int threads, bool skipBinary, BatchSummary *summary);
+void recordBatchError(BatchSummary *summary, const char *path, int error);
+void mergeBatchSummary(BatchSummary *summary, const BatchSummary *part);
+bool readManifest(const char *manifestPath, void (*visit)(char *path, void *context), void *context);
+void walkTrees(const fr_pattern *pattern, char **paths, int pathCount, const char *manifestPath, int workers,
+    BatchSummary *summary);
+bool addGlob(GlobList *list, char *glob);
 void obtainFiles(char *input, char *output);
-int checkSearchTextForW();
+bool sameFile(char *input, char *output);
+FILE *openSiblingTemp(char *path);
+bool patchFindReplace(const fr_pattern *pattern);
+int finishInPlace(int error);
+void discardInPlace();
+bool startDecompression();
+bool startCompression(const char *output);
+int finishCompression(int error);
 int checkErrors(char *input_file, char *output_file);
+int checkArgErrors();
 void srFlag(bool *flags, bool *argError, bool s_flag);
-void lFlag(int *start_end_lines);
+void lFlag();
 void wFlag();
-void scanArgs(const int argc, char* const* argv, int *start_end_lines);
+void EFlag();
+void iFlag();
+void uFlag();
+void tFlag();
+void jFlag();
+void fFlag();
+void bFlag();
+void mFlag();
+void RFlag();
+void xFlag();
+void statsFlag();
+void scanArgs(const int argc, char* const* argv);
 
@@ -0,0 +1,49 @@
+#ifndef MULTI_PATTERN_H
+#define MULTI_PATTERN_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//Results of findLeftmostLongest()
+#define MATCH_NONE 0
+#define MATCH_FOUND 1
+#define MATCH_UNDECIDED 2
+
+/*
+Rule is a search/replace pair of a rules file.
+mode = 0: replaces the search text, mode = 1: replaces words with the prefix, mode = 2: replaces words with the suffix.
+search never contains the '*' of the prefix/suffix modes.
+*/
+typedef struct {
+    char *search, *replace;
+    size_t searchLen, replaceLen;
+    int mode;
+} Rule;
+
+/*
+RuleSet holds all rules and the Aho-Corasick automaton built from their search texts. The automaton is a DFA over
+byte classes (bytes that appear in no search text share class 0), stored as next[state * classCount + class].
+With ignoreCase (i flag), the search texts are folded and an upper case letter shares the class of its lower case,
+so the automaton matches both without any other state.
+*/
+typedef struct {
+    Rule *rules;
+    size_t ruleCount, ruleCapacity;
+    bool hasSuffixRules, ignoreCase;
+    unsigned char byteClass[256];
+    int classCount;
+    int32_t *next, *depth, *longestRule;
+    size_t stateCount;
+} RuleSet;
+
+//Functions declarations
+
+bool addRule(RuleSet *rules, const char *search, const char *replace);
+int loadRules(RuleSet *rules, const char *path, bool wildcard);
+bool buildAutomaton(RuleSet *rules);
+int findLeftmostLongest(const RuleSet *rules, const char *texts, size_t textsLen, size_t from, bool complete, size_t *start,
+    int *rule);
+void freeRules(RuleSet *rules);
+
+#endif
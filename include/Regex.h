@@ -0,0 +1,135 @@
+#ifndef REGEX_H
+#define REGEX_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//Groups a replacement text may refer to: \0 (or &) for the whole match, \1 to \9 for the groups of the regex
+#define REGEX_GROUPS 10
+
+//Most instructions of each program of a regex, which bounds the copies made by {m,n}
+#define REGEX_MAX_INSTS 10000
+
+//Most groups nested in one another
+#define REGEX_MAX_DEPTH 256
+
+//Most states a LazyDfa keeps. Once they are all built, the DFA is thrown away and built again from the next state.
+#ifndef REGEX_CACHE_STATES
+#define REGEX_CACHE_STATES 1024
+#endif
+
+//Kinds of RegexInst
+#define INST_BYTE 0
+#define INST_SPLIT 1
+#define INST_JUMP 2
+#define INST_SAVE 3
+#define INST_LINE_START 4
+#define INST_LINE_END 5
+#define INST_MATCH 6
+
+/*
+RegexInst is an instruction of a Thompson NFA, which goes on to next once it is done.
+- INST_BYTE: consumes a byte of the byte set arg.
+- INST_SPLIT: goes on to both next and alt, next being preferred.
+- INST_SAVE: records the offset of slot arg (2 * group for the beginning of a group, 2 * group + 1 for its end).
+- INST_LINE_START, INST_LINE_END: only go on at the beginning/end of the line.
+- INST_MATCH: ends a match.
+*/
+typedef struct {
+    int kind, arg;
+    int32_t next, alt;
+} RegexInst;
+
+/*
+RegexProgram is the NFA of a regex, starting at instruction start. The reverse program matches the regex read
+backwards, so its INST_LINE_START stands for '$' and its INST_LINE_END for '^'.
+*/
+typedef struct {
+    RegexInst *insts;
+    int32_t instCount, instCapacity, start;
+} RegexProgram;
+
+/*
+ReplacePart is a piece of a replacement text: literal texts, or the texts matched by a group when group >= 0.
+*/
+typedef struct {
+    const char *texts;
+    size_t textsLen;
+    int group;
+} ReplacePart;
+
+/*
+Regex is a compiled search text of the E flag along with its replacement text.
+- forward, reverse: programs of the regex, both reading byte sets of sets.
+- byteClass: bytes that no byte set tells apart share a class (classCount classes). classByte holds a byte of
+  each class.
+- parts: pieces of the replacement text, whose literal texts point into replaceTexts.
+- groupsUsed: the replacement text refers to a group other than \0, so the groups of every match must be found.
+*/
+typedef struct {
+    RegexProgram forward, reverse;
+    uint64_t (*sets)[4];
+    int setCount, setCapacity;
+    unsigned char byteClass[256], classByte[256];
+    int classCount, groupCount;
+    ReplacePart *parts;
+    int partCount;
+    char *replaceTexts;
+    bool groupsUsed;
+} Regex;
+
+/*
+LazyDfa is a DFA over the byte classes of a regex, whose states (sets of instructions of a program) are only built
+once a scan reaches them. next[state * stride + class] is -1 until the transition is built, and the last two
+classes of a state are the end of the line (classCount) and the end of an empty line (classCount + 1), where '^'
+holds as well. State 0 is the empty set.
+An unanchored DFA adds the start of the program after every byte, so it follows the matches that begin anywhere.
+*/
+typedef struct {
+    const Regex *regex;
+    const RegexProgram *program;
+    bool unanchored;
+    int stride;
+    int32_t *next, *setOffsets, *setLens, *pool, *buckets, *stack, *work;
+    bool *accepting;
+    int32_t stateCount, poolLen, poolCapacity, bucketMask, workLen;
+    int32_t startStates[2];
+    uint32_t *marks, mark;
+    unsigned generation;
+} LazyDfa;
+
+/*
+RegexCache holds everything a context builds while it matches a regex, so the compiled regex is never written.
+- reverse, forward: unanchored DFA of the reverse program and anchored DFA of the forward program.
+- starts: bitmap of the offsets of a line where a match begins, from startsFrom on. lineStart tells whether the
+  texts of the line given to findRegexStarts() begin the line, where '^' holds.
+- checkStates: state of the last scan of the forward DFA at every 64th offset from startsFrom on, valid up to
+  scanTo (where the scan stopped) in generation scanGeneration of the DFA. scanEnd is the end of its match.
+- threads, groups: thread lists of the Pike VM that finds the groups of a match (see regexGroups()).
+*/
+typedef struct {
+    LazyDfa reverse, forward;
+    uint64_t *starts;
+    size_t startsCapacity, startsFrom, startsEnd;
+    bool lineStart;
+    int32_t *checkStates;
+    size_t scanTo, scanEnd;
+    unsigned scanGeneration;
+    int32_t *threads[2], threadCounts[2], *stack;
+    size_t *groups[2], *stackSlots;
+    uint32_t *marks, mark;
+} RegexCache;
+
+//Functions declarations
+
+int compileRegex(Regex *regex, const char *search, const char *replace, bool ignoreCase, char **prefix, size_t *prefixLen);
+void freeRegex(Regex *regex);
+RegexCache *newRegexCache(const Regex *regex);
+void freeRegexCache(RegexCache *cache);
+bool findRegexStarts(RegexCache *cache, const char *texts, size_t textsLen, size_t from, bool lineStart);
+size_t nextRegexStart(const RegexCache *cache, size_t from);
+size_t longestRegexMatch(RegexCache *cache, const char *texts, size_t textsLen, size_t start);
+void regexGroups(RegexCache *cache, const char *texts, size_t textsLen, size_t start, size_t end, size_t *groups);
+
+#endif
@@ -0,0 +1,207 @@
+#ifndef SEARCH_KERNEL_H
+#define SEARCH_KERNEL_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+
+//Number of match offsets a MatchCursor asks the search kernel for at once
+#define MATCH_BATCH 256
+
+//Patterns of up to FIXED_KERNEL_MAX bytes get search kernels specialized for their length
+#define FIXED_KERNEL_MAX 4
+
+//Patterns of at least TWO_WAY_MIN bytes are searched with the skip table of their PatternTable (see searchTwoWay())
+#ifndef TWO_WAY_MIN
+#define TWO_WAY_MIN 32
+#endif
+
+//Prefixes/suffixes of up to AFFIX_SCAN_MAX bytes, found in too many words for the search kernels to skip much of a
+//block, are found with an AffixScanner rather than searched
+#ifndef AFFIX_SCAN_MAX
+#define AFFIX_SCAN_MAX 1
+#endif
+
+typedef size_t (*SearchKernel)(const char *texts, size_t textsLen, const char *pattern, size_t patternLen,
+    size_t *offsets, size_t maxOffsets);
+
+//Finds the next window whose first and last bytes match a long pattern (see searchTwoWay())
+typedef size_t (*CandidateKernel)(const char *texts, size_t textsLen, const char *pattern, size_t patternLen);
+
+//Skips '\n' in a block (see skipNewlines())
+typedef size_t (*NewlineKernel)(const char *texts, size_t textsLen, long long *lines);
+
+/*
+WordClasses holds a set of word characters as nibble tables, which the vectorized kernels look up 32 bytes at a time
+(see buildWordClasses()). Bit h of rows[half][low] is set when the byte (8 * half + h) * 16 + low is in the set.
+*/
+typedef struct {
+    uint8_t rows[2][16];
+} WordClasses;
+
+//Finds the bytes of 64 bytes that are equal to a byte (once caseBit is set in them), or that are word characters
+//(see loadAffixWindow())
+typedef uint64_t (*ByteMaskKernel)(const char *texts, char byte, char caseBit);
+typedef uint64_t (*WordMaskKernel)(const char *texts, const WordClasses *classes);
+
+/*
+AffixScanner finds the words of a block that begin (or end, for a suffix) with an affix made of word characters, 64
+bytes at a time. The hits of a window are the offsets where the first and the last bytes of the affix are found, as
+the search kernels do, and where a word begins (or ends right after the affix). The word characters are only looked
+up in the windows that have a candidate, 64 bytes at once, so a short affix found in the middle of most words costs
+no branch per candidate. With fold, the affix is folded (see foldByte()) and so are the bytes compared with it.
+*/
+typedef struct {
+    ByteMaskKernel equalMask;
+    WordMaskKernel wordMask;
+    const WordClasses *classes;
+    const char *texts, *affix;
+    size_t textsLen, affixLen, base;
+    bool suffix, fold;
+    uint64_t hits;
+} AffixScanner;
+
+/*
+PatternTable holds what the Two-Way search of a long pattern derives from it once (see buildPatternTable()).
+- shift: distance from the last occurrence of a byte in the pattern to its end (the pattern length for bytes it
+  lacks), by which the window moves when its last byte doesn't match.
+- suffix: first byte of the right half of the critical factorization of the pattern.
+- period: period of the pattern when it is periodic, otherwise a lower bound of the distance between two matches.
+- folded: the pattern is folded and matches the texts whatever the case of their letters (see foldByte()). Both
+  cases of a letter then share their shift.
+*/
+typedef struct {
+    size_t shift[UCHAR_MAX + 1];
+    size_t suffix, period;
+    bool periodic, folded;
+} PatternTable;
+
+/*
+MatchCursor hands out the matches of a pattern in a block one by one. The offsets are found MATCH_BATCH at a
+time by a single pass of the search kernel, or of searchTwoWay() when table is set.
+*/
+typedef struct {
+    SearchKernel kernel;
+    const PatternTable *table;
+    const char *texts, *pattern;
+    size_t textsLen, patternLen;
+    size_t offsets[MATCH_BATCH];
+    size_t count, next, searchFrom;
+} MatchCursor;
+
+//Functions declarations
+
+size_t searchAll(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets);
+size_t searchAllScalar(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets);
+size_t searchAllSSE2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets);
+size_t searchAllAVX2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets);
+size_t searchFoldScalar(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets);
+size_t searchFoldSSE2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets);
+size_t searchFoldAVX2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets);
+void initSearchKernel();
+SearchKernel selectSearchKernel();
+SearchKernel selectFoldKernel(SearchKernel kernel);
+void selectFixedKernels(SearchKernel kernel, bool fold, SearchKernel *kernels);
+CandidateKernel selectCandidateKernel(SearchKernel kernel, bool fold);
+SearchKernel patternKernel(size_t patternLen);
+SearchKernel foldedPatternKernel(size_t patternLen);
+const char *searchKernelName();
+size_t findCandidateScalar(const char *texts, size_t textsLen, const char *pattern, size_t patternLen);
+size_t findCandidateSSE2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen);
+size_t findCandidateAVX2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen);
+size_t findFoldCandidateScalar(const char *texts, size_t textsLen, const char *pattern, size_t patternLen);
+size_t findFoldCandidateSSE2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen);
+size_t findFoldCandidateAVX2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen);
+void buildPatternTable(const char *pattern, size_t patternLen, bool fold, PatternTable *table);
+size_t searchTwoWay(const char *texts, size_t textsLen, const char *pattern, size_t patternLen,
+    const PatternTable *table, size_t *offsets, size_t maxOffsets);
+void initMatchCursor(MatchCursor *matches, const char *texts, size_t textsLen, const char *pattern, size_t patternLen,
+    SearchKernel kernel, const PatternTable *table);
+const char *nextMatch(MatchCursor *matches, size_t from);
+size_t skipNewlines(const char *texts, size_t textsLen, long long *lines);
+size_t skipNewlinesScalar(const char *texts, size_t textsLen, long long *lines);
+size_t skipNewlinesSSE2(const char *texts, size_t textsLen, long long *lines);
+size_t skipNewlinesAVX2(const char *texts, size_t textsLen, long long *lines);
+NewlineKernel selectNewlineKernel();
+void buildWordClasses(const bool *wordChars, WordClasses *classes);
+void selectMaskKernels(ByteMaskKernel *equalMask, WordMaskKernel *wordMask);
+uint64_t equalMaskScalar(const char *texts, char byte, char caseBit);
+uint64_t equalMaskAVX2(const char *texts, char byte, char caseBit);
+uint64_t wordMaskScalar(const char *texts, const WordClasses *classes);
+uint64_t wordMaskAVX2(const char *texts, const WordClasses *classes);
+void initAffixScanner(AffixScanner *words, const char *texts, size_t textsLen, const char *affix, size_t affixLen,
+    bool suffix, bool fold, const WordClasses *classes);
+void loadAffixWindow(AffixScanner *words, size_t base);
+
+
+//Folds an ASCII letter to lower case, as the search texts of the i flag are. Every other byte is kept as it is.
+static inline unsigned char foldByte(unsigned char c){
+    return (unsigned)(c - 'A') < 26 ? c | 0x20 : c;
+}
+
+//Bit that tells the two cases of a folded byte apart, or 0 if it is not a letter
+static inline char foldBit(unsigned char c){
+    return (unsigned)(c - 'a') < 26 ? 0x20 : 0;
+}
+
+static inline void foldText(char *texts, size_t textsLen){
+    for(size_t i = 0; i < textsLen; i++) texts[i] = foldByte(texts[i]);
+}
+
+
+/**
+ * @brief
+ *      Compares texts with a pattern, which is folded when fold is set (see foldByte()).
+ *
+ * @return
+ *      True if the texts match the pattern.
+ */
+static inline bool equalPattern(const char *texts, const char *pattern, size_t patternLen, bool fold){
+    if(!fold) return !memcmp(texts, pattern, patternLen);
+
+    for(size_t i = 0; i < patternLen; i++){
+        if(foldByte(texts[i]) != (unsigned char)pattern[i]) return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Finds the next word of a block that begins with the affix, or ends with it for a suffix.
+ *
+ * @param words
+ *      AffixScanner prepared by initAffixScanner().
+ *
+ * @param from
+ *      Offset where the scan begins. It must never decrease between calls.
+ *
+ * @return
+ *      Offset of the affix in the word, or the length of the block if there is none. A suffix at the very end of
+ *      the block is found as well, although the word might continue after the block.
+ */
+static inline size_t nextAffixWord(AffixScanner *words, size_t from){
+    while(from < words->textsLen){
+        size_t base = from & ~(size_t)63;
+        if(base != words->base) loadAffixWindow(words, base);
+
+        for(uint64_t hits = words->hits & (~0ULL << (from - base)); hits; hits &= hits - 1){
+            size_t offset = base + __builtin_ctzll(hits);
+            if(words->affixLen <= 2 || equalPattern(words->texts + offset + 1, words->affix + 1, words->affixLen - 2, words->fold))
+                return offset;
+        }
+        from = base + 64;
+    }
+    return words->textsLen;
+}
+
+#endif
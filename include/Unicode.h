@@ -0,0 +1,79 @@
+#ifndef UNICODE_H
+#define UNICODE_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+
+//Longest UTF-8 character, in bytes
+#define UTF8_MAX_LEN 4
+
+/*
+WordSet tells which characters belong to a word, which bound the words of the prefix/suffix/glob modes.
+- bytes: bytes that are word characters by themselves (the ASCII letters and digits).
+- utf8: the texts are read as UTF-8 (u flag). The bytes from 0x80 then make up characters of 2 to 4 bytes, which
+  belong to a word when they are Unicode letters, marks or digits (see unicodeWordChar()). Otherwise they never do.
+*/
+typedef struct {
+    bool bytes[UCHAR_MAX + 1];
+    bool utf8;
+} WordSet;
+
+//Functions declarations
+
+void initWordSet(WordSet *words, bool utf8);
+bool unicodeWordChar(uint32_t codePoint);
+size_t decodeUtf8(const char *texts, size_t textsLen, uint32_t *codePoint);
+size_t utf8WordCharAt(const char *texts, size_t textsLen, size_t offset);
+size_t utf8WordCharBefore(const char *texts, size_t from, size_t offset);
+size_t incompleteUtf8(const char *texts, size_t textsLen);
+
+
+/**
+ * @brief
+ *      Finds the word character that begins at an offset.
+ *
+ * @return
+ *      Number of bytes of the character, or 0 if it doesn't belong to a word.
+ */
+static inline size_t wordCharAt(const WordSet *words, const char *texts, size_t textsLen, size_t offset){
+    unsigned char c = texts[offset];
+
+    if(words->bytes[c]) return 1;
+    return words->utf8 && c >= 0x80 ? utf8WordCharAt(texts, textsLen, offset) : 0;
+}
+
+
+/**
+ * @brief
+ *      Finds the word character that ends right before an offset, which begins at or after from.
+ *
+ * @return
+ *      Number of bytes of the character, or 0 if it doesn't belong to a word.
+ */
+static inline size_t wordCharBefore(const WordSet *words, const char *texts, size_t from, size_t offset){
+    unsigned char c = texts[offset - 1];
+
+    if(words->bytes[c]) return 1;
+    return words->utf8 && c >= 0x80 ? utf8WordCharBefore(texts, from, offset) : 0;
+}
+
+
+/**
+ * @brief
+ *      Moves an offset back to the beginning of the UTF-8 character it falls in, so texts are never split in the
+ *      middle of a character. Offsets are kept as they are outside of the UTF-8 mode.
+ *
+ * @return
+ *      Offset of the character, which is never before from.
+ */
+static inline size_t charStart(const WordSet *words, const char *texts, size_t textsLen, size_t from, size_t offset){
+    for(int back = 1; words->utf8 && back < UTF8_MAX_LEN && offset > from && offset < textsLen; back++){
+        if(((unsigned char)texts[offset] & 0xC0) != 0x80) break;
+        offset--;
+    }
+    return offset;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef WORD_GLOB_H
+#define WORD_GLOB_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "Unicode.h"
+
+//Most characters of a glob other than '*', one bit of a state each
+#define GLOB_MAX_ITEMS 64
+
+/*
+WordGlob is a search text of the w flag with '*' (any characters of a word, possibly none) and '?' (one character
+of a word) anywhere, compiled for the Shift-And algorithm. Bit i of a state is set when the beginning of the word
+matches the glob up to its item i (its i-th character other than '*').
+- masks: items that accept a byte. '?' accepts every character of a word.
+- loops: items that stay set over a byte: those followed by a '*' over every byte, and in the UTF-8 mode a '?' over
+  the last bytes of its character.
+- floating: the glob begins with a '*', so item 0 may begin anywhere in the word.
+- accept: bit of the last item.
+*/
+typedef struct {
+    uint64_t masks[UCHAR_MAX + 1], loops[UCHAR_MAX + 1];
+    uint64_t accept;
+    bool floating;
+} WordGlob;
+
+//Functions declarations
+
+int compileWordGlob(WordGlob *glob, const char *search, const WordSet *words, bool fold, char **literal,
+    size_t *literalLen);
+bool matchWordGlob(const WordGlob *glob, const char *word, size_t wordLen);
+bool isWordGlob(const char *search);
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef LIBFINDREPLACE_H
+#define LIBFINDREPLACE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+libfindreplace performs the find/replace function of the FindReplace program on buffers and streams.
+
+A pattern is compiled once with fr_compile() and never changes afterwards, so any number of threads may use it at
+the same time. Each input is then fed to its own context (fr_context_new()), which holds everything that carries
+from one buffer to the next: the line number, the undecided texts at the end of the last buffer and the output.
+No function keeps any state outside of the pattern and the context it is given.
+
+fr_apply_stream() writes its output straight to the file descriptor of the output FILE, which must have one: a
+memory stream (fmemopen(), open_memstream()) makes it fail with FR_WRITE_FAILED every time. The input may be any
+stream. Output to memory goes through a context and its callback instead.
+*/
+
+//Error codes of the library (the same values as the exit codes of the FindReplace program)
+#define FR_OK 0
+#define FR_SEARCH_INVALID 4
+#define FR_REPLACE_INVALID 5
+#define FR_LINES_INVALID 6
+#define FR_WILDCARD_INVALID 7
+#define FR_RULES_FILE_INVALID 9
+#define FR_WRITE_FAILED 10
+#define FR_OUT_OF_MEMORY 11
+#define FR_READ_FAILED 12
+#define FR_REGEX_INVALID 13
+
+//Functions of the shared library that are visible to programs linking it
+#define FR_API __attribute__((visibility("default")))
+
+typedef struct fr_pattern fr_pattern;
+typedef struct fr_context fr_context;
+
+/*
+fr_options describes a pattern, with the same meaning as the flags of the FindReplace program.
+- search (s flag): search text, a prefix when it ends with '*' and a suffix when it starts with '*'. May be NULL
+  when rulesPath is set.
+- replace (r flag): replacement text, required with search.
+- rulesPath (f flag): rules file applied in the same pass, or NULL.
+- wildcard (w flag): every search text must be a prefix/suffix. search may also be a glob that whole words must
+  match, with '*' and '?' anywhere (ex. *ab*cd*), unless rulesPath is set.
+- regex (E flag): search is an extended regular expression and replace may refer to its groups (\1 to \9, & for
+  the whole match). It can't be combined with wildcard or rulesPath.
+- lineRange, startLine, endLine (l flag): when lineRange is set, only the lines from startLine to endLine
+  (inclusive, counted from 1) are replaced.
+- ignoreCase (i flag): search texts, rules and regexes match whatever the case of the ASCII letters.
+- utf8 (u flag): the input is read as UTF-8, whose letters, marks and digits belong to words as well as the ASCII
+  letters and digits. Only the words of the prefix/suffix modes and of the globs depend on it.
+*/
+typedef struct {
+    const char *search, *replace, *rulesPath;
+    bool wildcard, regex, lineRange, ignoreCase, utf8;
+    int startLine, endLine;
+} fr_options;
+
+/*
+fr_stats counts what the engine did with a context since it was created (see fr_context_stats()). The counters
+stay at 0 in a library built with -DNO_STATS.
+- bytesScanned: bytes handed to the find/replace kernels. bytesWritten: bytes of the output.
+- linesScanned: lines the line numbers went through up to the end of the range of the l flag, i.e. the lines before
+  the range, however they were skipped, and those in it. linesInRange: lines handed to the kernels (l flag).
+- candidates: matches of the search kernels. matches: candidates that were replaced, which excludes a prefix/suffix
+  that is not at the beginning/end of its word.
+- inputSeconds, outputSeconds: time spent reading a stream and writing the output.
+*/
+typedef struct {
+    unsigned long long bytesScanned, bytesWritten, linesScanned, linesInRange, candidates, matches;
+    double inputSeconds, outputSeconds;
+} fr_stats;
+
+//Receives the output of a context. texts are only valid during the call. Returns false if they couldn't be written.
+typedef bool (*fr_write_fn)(const char *texts, size_t textsLen, void *user);
+
+//Functions declarations
+
+FR_API int fr_compile(const fr_options *options, fr_pattern **pattern);
+FR_API void fr_free(fr_pattern *pattern);
+FR_API fr_context *fr_context_new(const fr_pattern *pattern, fr_write_fn write, void *user);
+FR_API void fr_context_free(fr_context *context);
+FR_API int fr_apply_buffer(fr_context *context, const char *texts, size_t textsLen, bool last);
+FR_API int fr_apply_stream(const fr_pattern *pattern, FILE *input, FILE *output, size_t *bytesRead);
+FR_API void fr_context_stats(const fr_context *context, fr_stats *stats);
+
+#endif
@@ -0,0 +1,230 @@
+/**
+ * @file Batch.c
+ *
+ * @brief
+ *      Edits a list of files in place with a single parsed search spec (b and m flags).
+ *
+ * @note
+ *      The search spec is compiled once into a pattern for the whole list, so each file only costs its own
+ *      I/O. A file that can't be read or replaced is reported in the
+ *      summary and skipped, and the remaining files are still processed.
+ */
+#include "FindReplace.h"
+
+//Number of bytes at the start of a file searched for a null character to tell if it is binary
+#define BINARY_PROBE 8192
+
+
+/**
+ * @brief
+ *      Checks if a file looks binary, i.e. its first BINARY_PROBE bytes contain a null character.
+ *
+ * @param fd
+ *      File descriptor of the file.
+ */
+static bool looksBinary(int fd){
+    char probe[BINARY_PROBE];
+    ssize_t probeLen = pread(fd, probe, BINARY_PROBE, 0);
+    return probeLen > 0 && memchr(probe, '\0', probeLen);
+}
+
+
+/**
+ * @brief
+ *      Reports a file that failed and counts it in the summary.
+ *
+ * @param summary
+ *      BatchSummary of the thread that processed the file.
+ *
+ * @param path
+ *      String indicating the file.
+ *
+ * @param error
+ *      INPUT_FILE_MISSING, OUTPUT_FILE_UNWRITABLE, OUTPUT_WRITE_FAILED or INPUT_READ_FAILED.
+ */
+void recordBatchError(BatchSummary *summary, const char *path, int error){
+    summary->errorCounts[error]++;
+    if(!summary->firstError) summary->firstError = error;
+    fprintf(stderr, "%s: %s (code %d)\n", path, error == INPUT_FILE_MISSING ? "INPUT_FILE_MISSING" :
+        error == OUTPUT_FILE_UNWRITABLE ? "OUTPUT_FILE_UNWRITABLE" : error == INPUT_READ_FAILED ? "INPUT_READ_FAILED" :
+        "OUTPUT_WRITE_FAILED", error);
+}
+
+
+/**
+ * @brief
+ *      Adds the counts of a summary to another one.
+ *
+ * @param summary
+ *      BatchSummary receiving the counts.
+ *
+ * @param part
+ *      BatchSummary of a single thread.
+ */
+void mergeBatchSummary(BatchSummary *summary, const BatchSummary *part){
+    summary->fileCount += part->fileCount;
+    summary->skippedCount += part->skippedCount;
+    summary->bytesRead += part->bytesRead;
+    for(int i = 0; i <= INPUT_READ_FAILED; i++) summary->errorCounts[i] += part->errorCounts[i];
+    if(!summary->firstError) summary->firstError = part->firstError;
+}
+
+
+/**
+ * @brief
+ *      Edits a single file of the batch in place.
+ *
+ * @param path
+ *      String indicating the file.
+ *
+ * @param pattern
+ *      Compiled pattern of the search/replace function.
+ *
+ * @param threads
+ *      Number of threads the file may be split between.
+ *
+ * @param skipBinary
+ *      Boolean value indicating whether the file is skipped when it looks binary.
+ *
+ * @param summary
+ *      BatchSummary that receives the result of the file.
+ */
+void replaceBatchFile(char *path, const fr_pattern *pattern, int threads, bool skipBinary, BatchSummary *summary){
+    const char *inputPath;
+    size_t bytesRead;
+    int error = 0;
+
+    inputFile = fopen(path, "r");
+    if(!inputFile) error = INPUT_FILE_MISSING;
+    else if(skipBinary && looksBinary(fileno(inputFile))){
+        fclose(inputFile);
+        summary->skippedCount++;
+        return;
+    }
+    else if(!(outputFile = openSiblingTemp(path))){
+        fclose(inputFile);
+        error = OUTPUT_FILE_UNWRITABLE;
+    }
+    else{
+        error = findReplace(pattern, threads, &inputPath, &bytesRead);
+        summary->bytesRead += bytesRead;
+        error = finishInPlace(error);
+        fclose(inputFile);
+    }
+
+    summary->fileCount++;
+    if(error) recordBatchError(summary, path, error);
+}
+
+
+/**
+ * @brief
+ *      Reads the paths of a manifest file.
+ *
+ * @note
+ *      The paths of a manifest file are separated by newlines. When the manifest is "-", the paths are read
+ *      from stdin separated by null characters (ex. find . -name '*.txt' -print0).
+ *
+ * @param manifestPath
+ *      String indicating the manifest file.
+ *
+ * @param visit
+ *      Function called with every path of the manifest.
+ *
+ * @param context
+ *      Pointer passed to visit.
+ *
+ * @return
+ *      False if the manifest couldn't be opened.
+ */
+bool readManifest(const char *manifestPath, void (*visit)(char *path, void *context), void *context){
+    bool fromStdin = !strcmp(manifestPath, "-");
+    FILE *manifest = fromStdin ? stdin : fopen(manifestPath, "r");
+    int delimiter = fromStdin ? '\0' : '\n';
+    char *path = NULL;
+    size_t pathCapacity = 0;
+    ssize_t pathLen;
+
+    if(!manifest) return false;
+
+    while((pathLen = getdelim(&path, &pathCapacity, delimiter, manifest)) != -1){
+        if(pathLen && path[pathLen - 1] == delimiter) path[--pathLen] = '\0';
+        if(!fromStdin && pathLen && path[pathLen - 1] == '\r') path[--pathLen] = '\0';
+        if(pathLen) visit(path, context);
+    }
+
+    free(path);
+    if(!fromStdin) fclose(manifest);
+    return true;
+}
+
+
+/*
+ManifestBatch carries the arguments of batchFindReplace() to the files of the manifest.
+*/
+typedef struct {
+    const fr_pattern *pattern;
+    BatchSummary *summary;
+} ManifestBatch;
+
+
+/**
+ * @brief
+ *      Edits a file of the manifest in place (see readManifest()).
+ */
+static void replaceManifestFile(char *path, void *context){
+    ManifestBatch *batch = context;
+    replaceBatchFile(path, batch->pattern, threadCount, false, batch->summary);
+}
+
+
+/**
+ * @brief
+ * Performs the corresponding find/replace function on every file of the batch, editing each one in place.
+ *
+ * @param pattern
+ *      Compiled pattern of the search/replace function.
+ *
+ * @param paths
+ *      Array of the files entered as command line arguments.
+ *
+ * @param pathCount
+ *      Number of files in paths.
+ *
+ * @param manifestPath
+ *      String indicating the manifest file (m flag), or NULL.
+ *
+ * @param treeWorkers
+ *      Number of worker threads that walk the directories of the batch (R flag), or 0 to edit the files
+ *      one after another.
+ *
+ * @param bytesRead
+ *      Pointer that is set to the number of bytes read from all files.
+ *
+ * @return
+ *      Error code of the first file that failed (or INPUT_FILE_MISSING if the manifest couldn't be opened),
+ *      otherwise 0.
+ */
+int batchFindReplace(const fr_pattern *pattern, char **paths, int pathCount, const char *manifestPath, int treeWorkers,
+    size_t *bytesRead){
+    BatchSummary summary = {0};
+    ManifestBatch batch = {.pattern = pattern, .summary = &summary};
+
+    if(treeWorkers) walkTrees(pattern, paths, pathCount, manifestPath, treeWorkers, &summary);
+    else{
+        for(int i = 0; i < pathCount; i++) replaceBatchFile(paths[i], pattern, threadCount, false, &summary);
+        if(manifestPath && !readManifest(manifestPath, replaceManifestFile, &batch))
+            recordBatchError(&summary, manifestPath, INPUT_FILE_MISSING);
+    }
+
+    size_t failed = summary.errorCounts[INPUT_FILE_MISSING] + summary.errorCounts[OUTPUT_FILE_UNWRITABLE] +
+        summary.errorCounts[OUTPUT_WRITE_FAILED] + summary.errorCounts[INPUT_READ_FAILED];
+    if(failed){
+        fprintf(stderr, "%zu of %zu files failed (INPUT_FILE_MISSING: %zu, OUTPUT_FILE_UNWRITABLE: %zu, OUTPUT_WRITE_FAILED: %zu, INPUT_READ_FAILED: %zu)\n",
+            failed, summary.fileCount, summary.errorCounts[INPUT_FILE_MISSING], summary.errorCounts[OUTPUT_FILE_UNWRITABLE],
+            summary.errorCounts[OUTPUT_WRITE_FAILED], summary.errorCounts[INPUT_READ_FAILED]);
+    }
+
+    *bytesRead = summary.bytesRead;
+    return summary.firstError;
+}
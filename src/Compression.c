@@ -0,0 +1,453 @@
+/**
+ * @file Compression.c
+ *
+ * @brief
+ *      Reads gzip/zstd compressed input files and writes compressed output files (see obtainFiles()).
+ *
+ * @note
+ *      A compressed input is decompressed by a reader thread into a pipe, which becomes the inputFile, and the
+ *      output is compressed by a writer thread from a pipe, which becomes the outputFile. The pipes are bounded
+ *      ring buffers between the codecs and the find/replace function, so all three run at the same time and
+ *      the one that runs ahead simply blocks. The input codec is recognized by the magic bytes of the file and
+ *      the output codec by the name of the output file. Codecs whose library wasn't found at build time are left
+ *      out (see the Makefile), and their files are then read/written as they are.
+ */
+#include "FindReplace.h"
+
+#include <signal.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+//Codecs of the inputFile/outputFile, NO_CODEC when they are read/written as they are
+_Thread_local int inputCodec = NO_CODEC, outputCodec = NO_CODEC;
+
+/*
+CodecStream is a codec thread moving texts between a compressed file and its end of a pipe, through the buffers
+in and out of CODEC_BLOCK_SIZE bytes. A reading stream decompresses the file into the pipe, otherwise the pipe is
+compressed into the file. failed is set when the file couldn't be read/written completely or its texts
+are corrupted.
+*/
+typedef struct {
+    int codec;
+    bool reading;
+    FILE *file;
+    int pipeFd;
+    char *in, *out;
+    pthread_t thread;
+    bool failed;
+} CodecStream;
+
+static _Thread_local CodecStream reader, writer;
+
+
+/**
+ * @brief
+ *      Recognizes the codec of a compressed input by its magic bytes, without consuming them.
+ *
+ * @note
+ *      Regular files are peeked with pread(). Other inputs (e.g. pipes) can't be seeked, so the bytes peeked
+ *      through the FILE are pushed back with ungetc(), which glibc allows for as many bytes as were just read.
+ *
+ * @param input
+ *      Input file, positioned where the find/replace function would start reading.
+ *
+ * @return
+ *      GZIP_CODEC, ZSTD_CODEC, or NO_CODEC if the input isn't compressed or its codec wasn't built.
+ */
+static int detectCodec(FILE *input){
+    unsigned char magic[4];
+    size_t magicLen = 0;
+    struct stat inputStat;
+    int inputFd = fileno(input);
+
+    if(!fstat(inputFd, &inputStat) && S_ISREG(inputStat.st_mode)){
+        off_t offset = lseek(inputFd, 0, SEEK_CUR);
+        ssize_t peeked = offset < 0 ? -1 : pread(inputFd, magic, sizeof(magic), offset);
+        if(peeked > 0) magicLen = peeked;
+    }
+    else{
+        int c;
+        while(magicLen < sizeof(magic) && (c = getc(input)) != EOF) magic[magicLen++] = c;
+        for(size_t i = magicLen; i > 0; i--) ungetc(magic[i - 1], input);
+    }
+
+#ifdef HAVE_ZLIB
+    if(magicLen >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) return GZIP_CODEC;
+#endif
+#ifdef HAVE_ZSTD
+    if(magicLen == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) return ZSTD_CODEC;
+#endif
+    return NO_CODEC;
+}
+
+
+/**
+ * @brief
+ *      Recognizes the codec asked for by the name of an output file (.gz or .zst).
+ *
+ * @param output
+ *      String indicating the output file.
+ *
+ * @return
+ *      GZIP_CODEC, ZSTD_CODEC, or NO_CODEC if the output isn't compressed or its codec wasn't built.
+ */
+static int codecOfName(const char *output){
+    size_t outputLen = strlen(output);
+
+#ifdef HAVE_ZLIB
+    if(outputLen > 3 && !strcmp(output + outputLen - 3, ".gz")) return GZIP_CODEC;
+#endif
+#ifdef HAVE_ZSTD
+    if(outputLen > 4 && !strcmp(output + outputLen - 4, ".zst")) return ZSTD_CODEC;
+#endif
+    (void)outputLen;
+    return NO_CODEC;
+}
+
+
+/**
+ * @brief
+ *      Reads the next texts a writer thread has to compress from its pipe.
+ *
+ * @return
+ *      Number of bytes read, 0 once the pipe is closed. A read error is treated as the end of the pipe and
+ *      marks the stream as failed.
+ */
+#if defined(HAVE_ZLIB) || defined(HAVE_ZSTD)
+static size_t readPipe(CodecStream *stream, char *texts, size_t textsLen){
+    ssize_t bytesRead;
+
+    while((bytesRead = read(stream->pipeFd, texts, textsLen)) < 0 && errno == EINTR);
+    if(bytesRead < 0) stream->failed = true;
+    return bytesRead > 0 ? bytesRead : 0;
+}
+#endif
+
+
+#ifdef HAVE_ZLIB
+/**
+ * @brief
+ *      Decompresses a gzip input into the pipe of a reader thread. Members concatenated one after another (as
+ *      written by cat a.gz b.gz) are decompressed in turn.
+ *
+ * @return
+ *      False if the input is corrupted or truncated, or the pipe was closed before the end.
+ */
+static bool inflateInput(CodecStream *stream, char *in, char *out){
+    z_stream z = {0};
+    bool ended = false, ok = inflateInit2(&z, 15 + 32) == Z_OK, outputFull = false;
+
+    while(ok){
+        //A full output means zlib may still hold texts of the input already passed.
+        if(!z.avail_in && !outputFull){
+            size_t inLen = fread(in, 1, CODEC_BLOCK_SIZE, stream->file);
+            if(!inLen) break;
+            z.next_in = (Bytef *)in;
+            z.avail_in = inLen;
+        }
+
+        z.next_out = (Bytef *)out;
+        z.avail_out = CODEC_BLOCK_SIZE;
+        int status = inflate(&z, Z_NO_FLUSH);
+
+        //Z_BUF_ERROR only means nothing could be done, e.g. right after the last member ended.
+        if(status == Z_STREAM_END){
+            ended = true;
+            ok = inflateReset(&z) == Z_OK;
+        }
+        else if(status == Z_OK) ended = false;
+        else if(status != Z_BUF_ERROR) ok = false;
+
+        outputFull = !z.avail_out;
+        ok = ok && writeAll(stream->pipeFd, out, CODEC_BLOCK_SIZE - z.avail_out);
+    }
+
+    inflateEnd(&z);
+    return ok && ended && !ferror(stream->file);
+}
+
+
+/**
+ * @brief
+ *      Compresses the texts of the pipe of a writer thread into a gzip output.
+ *
+ * @note
+ *      Once the output fails, the pipe is still drained until it is closed, so the find/replace function never
+ *      blocks on it.
+ *
+ * @return
+ *      False if the output couldn't be written completely.
+ */
+static bool deflateOutput(CodecStream *stream, char *in, char *out){
+    z_stream z = {0};
+    bool ok = deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    int flush = Z_NO_FLUSH;
+
+    while(flush != Z_FINISH){
+        size_t inLen = readPipe(stream, in, CODEC_BLOCK_SIZE);
+        if(!inLen) flush = Z_FINISH;
+        if(!ok) continue;
+
+        z.next_in = (Bytef *)in;
+        z.avail_in = inLen;
+        do{
+            z.next_out = (Bytef *)out;
+            z.avail_out = CODEC_BLOCK_SIZE;
+            deflate(&z, flush);
+            ok = writeAll(fileno(stream->file), out, CODEC_BLOCK_SIZE - z.avail_out);
+        } while(ok && !z.avail_out);
+    }
+
+    deflateEnd(&z);
+    return ok;
+}
+#endif
+
+
+#ifdef HAVE_ZSTD
+/**
+ * @brief
+ *      Decompresses a zstd input into the pipe of a reader thread. Frames concatenated one after another are
+ *      decompressed in turn.
+ *
+ * @return
+ *      False if the input is corrupted or truncated, or the pipe was closed before the end.
+ */
+static bool zstdDecompressInput(CodecStream *stream, char *in, char *out){
+    ZSTD_DCtx *dctx = ZSTD_createDCtx();
+    ZSTD_inBuffer input = {in, 0, 0};
+    size_t remaining = 0;
+    bool ok = (dctx != NULL), outputFull = false;
+
+    while(ok){
+        //A full output means zstd may still hold texts of the input already passed.
+        if(input.pos == input.size && !outputFull){
+            size_t inLen = fread(in, 1, CODEC_BLOCK_SIZE, stream->file);
+            if(!inLen) break;
+            input.size = inLen;
+            input.pos = 0;
+        }
+
+        ZSTD_outBuffer output = {out, CODEC_BLOCK_SIZE, 0};
+        size_t consumed = input.pos, hint = ZSTD_decompressStream(dctx, &output, &input);
+
+        //hint is 0 once a frame is complete, unless the call did nothing (e.g. right after the last frame ended).
+        if(input.pos != consumed || output.pos) remaining = hint;
+        outputFull = (output.pos == output.size);
+        ok = !ZSTD_isError(hint) && writeAll(stream->pipeFd, out, output.pos);
+    }
+
+    ZSTD_freeDCtx(dctx);
+    return ok && !remaining && !ferror(stream->file);
+}
+
+
+/**
+ * @brief
+ *      Compresses the texts of the pipe of a writer thread into a zstd output.
+ *
+ * @note
+ *      Once the output fails, the pipe is still drained until it is closed, so the find/replace function never
+ *      blocks on it.
+ *
+ * @return
+ *      False if the output couldn't be written completely.
+ */
+static bool zstdCompressOutput(CodecStream *stream, char *in, char *out){
+    ZSTD_CCtx *cctx = ZSTD_createCCtx();
+    bool ok = (cctx != NULL), finished = false;
+
+    while(!finished){
+        size_t inLen = readPipe(stream, in, CODEC_BLOCK_SIZE);
+        ZSTD_EndDirective mode = inLen ? ZSTD_e_continue : ZSTD_e_end;
+        ZSTD_inBuffer input = {in, inLen, 0};
+
+        finished = !inLen;
+        if(!ok) continue;
+
+        //With ZSTD_e_end, the frame is complete once nothing remains to be flushed.
+        size_t remaining;
+        do{
+            ZSTD_outBuffer output = {out, CODEC_BLOCK_SIZE, 0};
+            remaining = ZSTD_compressStream2(cctx, &output, &input, mode);
+            ok = !ZSTD_isError(remaining) && writeAll(fileno(stream->file), out, output.pos);
+        } while(ok && (mode == ZSTD_e_end ? remaining != 0 : input.pos < input.size));
+    }
+
+    ZSTD_freeCCtx(cctx);
+    return ok;
+}
+#endif
+
+
+/**
+ * @brief
+ *      Body of a codec thread: decompresses the file of a reader into its pipe, or compresses the pipe of a
+ *      writer into its file.
+ *
+ * @note
+ *      SIGPIPE is blocked in the thread, so a pipe closed early by the find/replace function (e.g. once the
+ *      output failed) only makes the reader stop.
+ *
+ * @param arg
+ *      CodecStream of the thread.
+ */
+static void *runCodec(void *arg){
+    CodecStream *stream = arg;
+    bool ok = false;
+    sigset_t pipeSignal;
+
+    sigemptyset(&pipeSignal);
+    sigaddset(&pipeSignal, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeSignal, NULL);
+
+#ifdef HAVE_ZLIB
+    if(stream->codec == GZIP_CODEC)
+        ok = stream->reading ? inflateInput(stream, stream->in, stream->out)
+            : deflateOutput(stream, stream->in, stream->out);
+#endif
+#ifdef HAVE_ZSTD
+    if(stream->codec == ZSTD_CODEC)
+        ok = stream->reading ? zstdDecompressInput(stream, stream->in, stream->out)
+            : zstdCompressOutput(stream, stream->in, stream->out);
+#endif
+
+    if(!ok) stream->failed = true;
+    close(stream->pipeFd);
+    free(stream->in);
+    free(stream->out);
+    return NULL;
+}
+
+
+/**
+ * @brief
+ *      Starts the thread of a codec stream, connected to the find/replace function through a new pipe.
+ *
+ * @param stream
+ *      reader or writer.
+ *
+ * @param codec
+ *      Codec of the file.
+ *
+ * @param file
+ *      Compressed file, which is kept by the stream until finishCompression().
+ *
+ * @param reading
+ *      Boolean value indicating whether the file is decompressed into the pipe rather than compressed from it.
+ *
+ * @return
+ *      End of the pipe used by the find/replace function, or NULL if the thread couldn't be started.
+ */
+static FILE *startCodec(CodecStream *stream, int codec, FILE *file, bool reading){
+    int pipeFds[2];
+
+    if(pipe2(pipeFds, O_CLOEXEC)) return NULL;
+    fcntl(pipeFds[0], F_SETPIPE_SZ, CODEC_PIPE_SIZE);
+
+    stream->codec = codec;
+    stream->reading = reading;
+    stream->file = file;
+    stream->pipeFd = reading ? pipeFds[1] : pipeFds[0];
+    stream->in = malloc(CODEC_BLOCK_SIZE);
+    stream->out = malloc(CODEC_BLOCK_SIZE);
+    stream->failed = false;
+
+    int endFd = reading ? pipeFds[0] : pipeFds[1];
+    FILE *end = fdopen(endFd, reading ? "r" : "w");
+
+    if(!end || !stream->in || !stream->out || pthread_create(&stream->thread, NULL, runCodec, stream)){
+        if(end) fclose(end);
+        else close(endFd);
+        close(stream->pipeFd);
+        free(stream->in);
+        free(stream->out);
+        return NULL;
+    }
+    return end;
+}
+
+
+/**
+ * @brief
+ *      Decompresses the inputFile on a reader thread if it is compressed, replacing it with the pipe the
+ *      texts are decompressed into.
+ *
+ * @return
+ *      False if the input is compressed but the reader thread couldn't be started.
+ */
+bool startDecompression(){
+    int codec = detectCodec(inputFile);
+    if(codec == NO_CODEC) return true;
+
+    FILE *decompressed = startCodec(&reader, codec, inputFile, true);
+    if(!decompressed) return false;
+
+    inputFile = decompressed;
+    inputCodec = codec;
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Compresses the outputFile on a writer thread if the name of the output asks for it, replacing it with
+ *      the pipe the texts are compressed from.
+ *
+ * @param output
+ *      String indicating the output file.
+ *
+ * @return
+ *      False if the output is compressed but the writer thread couldn't be started.
+ */
+bool startCompression(const char *output){
+    int codec = codecOfName(output);
+    if(codec == NO_CODEC) return true;
+
+    FILE *compressed = startCodec(&writer, codec, outputFile, false);
+    if(!compressed) return false;
+
+    outputFile = compressed;
+    outputCodec = codec;
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Stops the codec threads of the inputFile/outputFile and puts the compressed files back in their place.
+ *
+ * @note
+ *      Closing the pipe of the outputFile lets the writer thread complete the compressed output, which is
+ *      written once this returns.
+ *
+ * @param error
+ *      Error code of the find/replace function, or 0 if it succeeded.
+ *
+ * @return
+ *      The error code, or INPUT_READ_FAILED/OUTPUT_WRITE_FAILED if a codec thread failed on its own.
+ */
+int finishCompression(int error){
+    if(inputCodec != NO_CODEC){
+        fclose(inputFile);
+        pthread_join(reader.thread, NULL);
+        inputFile = reader.file;
+        inputCodec = NO_CODEC;
+        if(reader.failed && !error) error = INPUT_READ_FAILED;
+    }
+
+    if(outputCodec != NO_CODEC){
+        if(fclose(outputFile) && !error) error = OUTPUT_WRITE_FAILED;
+        pthread_join(writer.thread, NULL);
+        outputFile = writer.file;
+        outputCodec = NO_CODEC;
+        if(writer.failed && !error) error = OUTPUT_WRITE_FAILED;
+    }
+    return error;
+}
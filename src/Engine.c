@@ -0,0 +1,1237 @@
+/**
+ * @file Engine.c
+ *
+ * @brief
+ *      Performs the find/replace function of a compiled pattern on blocks of texts and sends the results to
+ *      the output target of a context.
+ *
+ * @note
+ *      Every function only works on the pattern and the context it is given, so the engine may run on any
+ *      number of contexts at the same time (see libfindreplace.h).
+ */
+#include "Engine.h"
+
+
+/**
+ * @brief
+ *      Sets up a context that feeds its input to a pattern from the first line.
+ *
+ * @param context
+ *      Context to be set up.
+ *
+ * @param pattern
+ *      Compiled pattern.
+ *
+ * @param kind
+ *      Kind of the output target. The fields of the target that kind uses (fd, buffer, etc.) are set by the
+ *      caller.
+ */
+void initContext(fr_context *context, const fr_pattern *pattern, int kind){
+    context->pattern = pattern;
+    context->output.kind = kind;
+    context->output.failed = false;
+    context->output.vecCount = 0;
+    context->output.bufferLen = 0;
+    context->output.memory = NULL;
+    context->output.memoryLen = context->output.memoryCapacity = 0;
+    context->output.patchOffset = 0;
+    context->output.stats = &context->stats;
+    memset(&context->stats, 0, sizeof(context->stats));
+    context->lineNum = 1;
+    context->lineStart = true;
+    context->wordBefore = false;
+    context->wordState = WORD_NONE;
+    context->carry = NULL;
+    context->carryLen = context->carryCapacity = 0;
+    context->regexCache = NULL;
+}
+
+
+/**
+ * @brief
+ *      Frees what a context allocated while it fed its input to the pattern (see regexCache). The output target
+ *      and the carry belong to the caller.
+ *
+ * @param context
+ *      Context that is done with its input.
+ */
+void releaseContext(fr_context *context){
+    freeRegexCache(context->regexCache);
+    context->regexCache = NULL;
+}
+
+
+/**
+ * @brief 
+ * Performs the corresponding find/replace function on every line of a block, starting at the line number of
+ * the context.
+ * 
+ * @note
+ *      When a find/replace function cannot decide the end of the block yet (e.g. a match might cross into the
+ *      next block), the undecided texts are left to be searched again with the texts that follow. Line numbers
+ *      only advance on '\n'. The lines before the l flag range are only scanned for their newlines and printed
+ *      together, and the texts after it are printed without being scanned. In the UTF-8 mode, the kernels never see
+ *      a character cut by the end of the block.
+ * 
+ * @param context
+ *      Context of the input.
+ * 
+ * @param texts
+ *      Beginning of the block.
+ * 
+ * @param textsLen
+ *      Number of characters in the block.
+ * 
+ * @param complete
+ *      Boolean value indicating whether the block reaches the end of the input.
+ * 
+ * @return
+ *      Number of characters consumed, which is textsLen when the block is complete.
+ */
+size_t replaceLines(fr_context *context, const char *texts, size_t textsLen, bool complete){
+    const int *start_end_lines = context->pattern->start_end_lines;
+    LineKernel kernel = context->pattern->plan.kernel;
+    const WordSet *words = &context->pattern->plan.words;
+    size_t pos = 0;
+
+    while(pos < textsLen){
+        size_t skipped = pos;
+        if(context->lineNum < start_end_lines[0]){
+            long long lines = start_end_lines[0] - context->lineNum;
+            pos += skipNewlines(texts + pos, textsLen - pos, &lines);
+            COUNT_STAT(&context->stats, linesScanned, start_end_lines[0] - context->lineNum - lines);
+            context->lineNum = start_end_lines[0] - lines;
+        }
+        if(context->lineNum > start_end_lines[1]) pos = textsLen;
+        if(pos > skipped){
+            writeText(&context->output, texts + skipped, pos - skipped);
+            continue;
+        }
+
+        const char *newline = memchr(texts + pos, '\n', textsLen - pos);
+        size_t lineEnd = newline ? (size_t)(newline - texts) + 1 : textsLen;
+
+        //In the UTF-8 mode, a character cut by the end of the block is left whole for the next block.
+        size_t kernelEnd = lineEnd;
+        if(words->utf8 && !newline && !complete) kernelEnd -= incompleteUtf8(texts + pos, lineEnd - pos);
+        if(kernelEnd == pos) break;
+
+        pos += kernel(context, texts + pos, kernelEnd - pos, newline || complete);
+        if(pos < lineEnd) break; //The rest of the line is left for the next block.
+        if(newline) context->lineNum++;
+        if(newline || complete){
+            COUNT_STAT(&context->stats, linesScanned, 1);
+            COUNT_STAT(&context->stats, linesInRange, 1);
+        }
+    }
+    COUNT_STAT(&context->stats, bytesScanned, pos);
+    return pos;
+}
+
+
+/**
+ * @brief 
+ * Reads an input in blocks of BLOCK_SIZE bytes and performs the corresponding find/replace function on every
+ * line.
+ * 
+ * @note
+ *      Lines may be longer than a block. The undecided texts at the end of a block (see replaceLines()) are
+ *      carried over to the front of the buffer and searched again once the next block is read.
+ * 
+ * @param context
+ *      Context of the input.
+ * 
+ * @param input
+ *      Input to be read.
+ * 
+ * @param buffer
+ *      Pointer to the buffer of the blocks, which is allocated (or enlarged) as needed and kept for the caller.
+ * 
+ * @param capacity
+ *      Pointer to the number of bytes in buffer.
+ * 
+ * @param bytesRead
+ *      Pointer that is set to the number of bytes read from the input.
+ * 
+ * @return
+ *      FR_READ_FAILED if the input couldn't be read to its end, FR_OUT_OF_MEMORY if the buffer couldn't be
+ *      allocated or enlarged, otherwise FR_OK. Reading also stops early once the output fails, which the output
+ *      target records.
+ */
+int streamReplace(fr_context *context, FILE *input, char **buffer, size_t *capacity, size_t *bytesRead){
+    size_t carried = 0;
+
+    *bytesRead = 0;
+    if(!*buffer && (*buffer = malloc(BLOCK_SIZE))) *capacity = BLOCK_SIZE;
+    if(!*buffer) return FR_OUT_OF_MEMORY;
+
+    while(true){
+        size_t blockRead;
+        TIME_STAT(&context->stats, inputSeconds, blockRead = fread(*buffer + carried, 1, *capacity - carried, input));
+
+        //A short read is the end of the input, unless it was cut by an error.
+        if(blockRead < *capacity - carried && ferror(input)) return FR_READ_FAILED;
+
+        size_t blockLen = carried + blockRead;
+        bool endOfFile = (blockRead == 0);
+        *bytesRead += blockRead;
+
+        size_t pos = context->pattern->plan.bytePatch ? patchBlock(context, *buffer, blockLen, endOfFile)
+            : replaceLines(context, *buffer, blockLen, endOfFile);
+        if(endOfFile || context->output.failed) break;
+
+        carried = blockLen - pos;
+        memmove(*buffer, *buffer + pos, carried);
+
+        //Only a suffix/glob search waiting for the end of a word, or a regex waiting for the end of a line after the
+        //first match of its prefix, longer than the whole buffer could fill it up.
+        if(carried == *capacity){
+            char *larger = realloc(*buffer, *capacity * 2);
+            if(!larger) return FR_OUT_OF_MEMORY;
+            *buffer = larger;
+            *capacity *= 2;
+        }
+    }
+    return FR_OK;
+}
+
+
+/**
+ * @brief
+ * Overwrites every match of the search text in a block with the replacement text, and prints the block. Only
+ * used when the plan of the pattern has bytePatch set, so the block is never split into lines.
+ * 
+ * @note
+ *      The block is patched where it is. A PATCH_OUTPUT target over the same block then has nothing left to
+ *      copy, so a mapping of the file is only written at the matches.
+ * 
+ * @param context
+ *      Context of the input.
+ * 
+ * @param texts
+ *      Block of the input, which is overwritten.
+ * 
+ * @param textsLen
+ *      Number of characters in the block.
+ * 
+ * @param complete
+ *      Boolean value indicating whether the block reaches the end of the input.
+ * 
+ * @return
+ *      Number of characters printed in the output. When the block is incomplete, the last searchLen - 1
+ *      characters are left to be searched with the next block.
+ */
+size_t patchBlock(fr_context *context, char *texts, size_t textsLen, bool complete){
+    const fr_pattern *pattern = context->pattern;
+    size_t searchLen = pattern->searchLen, cursor = 0, end = textsLen;
+    const char *found;
+
+    MatchCursor matches;
+    initMatchCursor(&matches, texts, textsLen, pattern->search, searchLen, pattern->plan.search, &pattern->plan.table);
+
+    //The texts before the cursor are never searched again, so patching them can't create or hide a match.
+    while((found = nextMatch(&matches, cursor))){
+        cursor = found - texts;
+        memcpy(texts + cursor, pattern->replace, searchLen);
+        cursor += searchLen;
+        COUNT_STAT(&context->stats, candidates, 1);
+        COUNT_STAT(&context->stats, matches, 1);
+    }
+
+    if(!complete) end = textsLen - cursor >= searchLen ? textsLen - (searchLen - 1) : cursor;
+    writeText(&context->output, texts, end);
+    COUNT_STAT(&context->stats, bytesScanned, end);
+    return end;
+}
+
+
+/**
+ * @brief
+ * Prints a whole input with the replacement text overwritten at every match of the search text, through the
+ * page-aligned buffer of a BUFFER_OUTPUT target. Only used when the plan of the pattern has bytePatch set.
+ * 
+ * @note
+ *      Each part of the input is copied into the buffer once, the matches in that part are overwritten and the
+ *      buffer is written in one call. Parts without any match are written straight from the input. A match
+ *      that crosses the end of a part is finished at the beginning of the next one.
+ * 
+ * @param context
+ *      Context of the input, with a BUFFER_OUTPUT target.
+ * 
+ * @param texts
+ *      Whole input, which is left untouched.
+ * 
+ * @param textsLen
+ *      Number of characters in the input.
+ */
+void patchedCopy(fr_context *context, const char *texts, size_t textsLen){
+    const fr_pattern *pattern = context->pattern;
+    OutputTarget *target = &context->output;
+    size_t searchLen = pattern->searchLen, pos = 0;
+
+    MatchCursor matches;
+    initMatchCursor(&matches, texts, textsLen, pattern->search, searchLen, pattern->plan.search, &pattern->plan.table);
+    const char *found = nextMatch(&matches, 0);
+
+    flushOutput(target);
+    COUNT_STAT(&context->stats, bytesScanned, textsLen);
+    while(pos < textsLen && !target->failed){
+        size_t partLen = textsLen - pos < WRITE_BUFFER_SIZE ? textsLen - pos : WRITE_BUFFER_SIZE, partEnd = pos + partLen;
+
+        if(!found || (size_t)(found - texts) >= partEnd){
+            bool written;
+            TIME_STAT(&context->stats, outputSeconds, written = writeAll(target->fd, texts + pos, partLen));
+            COUNT_STAT(&context->stats, bytesWritten, partLen);
+            if(!written) target->failed = true;
+            pos = partEnd;
+            continue;
+        }
+
+        memcpy(target->buffer, texts + pos, partLen);
+        while(found && (size_t)(found - texts) < partEnd){
+            size_t start = found - texts, from = start > pos ? start : pos,
+                to = start + searchLen < partEnd ? start + searchLen : partEnd;
+            memcpy(target->buffer + (from - pos), pattern->replace + (from - start), to - from);
+            if(start >= pos){
+                COUNT_STAT(&context->stats, candidates, 1);
+                COUNT_STAT(&context->stats, matches, 1);
+            }
+
+            if(start + searchLen > partEnd) break;
+            found = nextMatch(&matches, start + searchLen);
+        }
+
+        target->bufferLen = partLen;
+        COUNT_STAT(&context->stats, bytesWritten, partLen);
+        flushOutput(target);
+        pos = partEnd;
+    }
+}
+
+
+/**
+ * @brief 
+ * Prints a line as it is. It is the find/replace function of a search text equal to its replacement text.
+ * 
+ * @param context
+ *      Context of the input.
+ * 
+ * @param curr_line
+ *      Line (or the beginning of a line) being read by the program.
+ * 
+ * @param lineLen
+ *      Length or number of characters in curr_line.
+ * 
+ * @param complete
+ *      Boolean value indicating whether curr_line reaches the end of the line.
+ * 
+ * @return
+ *      Number of characters printed in the output, always lineLen.
+ */
+size_t copyLine(fr_context *context, const char *curr_line, size_t lineLen, bool complete){
+    (void)complete;
+    writeText(&context->output, curr_line, lineLen);
+    return lineLen;
+}
+
+
+/**
+ * @brief 
+ * Hands texts to an output target.
+ * 
+ * @note
+ *      A BUFFER_OUTPUT target copies the texts into its buffer, and only writes the buffer once it is full.
+ *      Texts that don't fit in the whole buffer are written straight away.
+ * @note
+ *      GATHER_OUTPUT and CALLBACK_OUTPUT targets only record the texts as an iovec (merged with the previous
+ *      one when they are adjacent in memory), which is written by flushOutput(). The texts must stay valid
+ *      until then.
+ * @note
+ *      A MEMORY_OUTPUT target copies the texts to the end of its growing buffer, and fails once it can't grow.
+ * 
+ * @param target
+ *      Output target of the context.
+ * 
+ * @param texts
+ *      Texts to be printed.
+ * 
+ * @param textsLen
+ *      Number of characters to be printed.
+ */
+void writeText(OutputTarget *target, const char *texts, size_t textsLen){
+    if(!textsLen || target->failed) return;
+    COUNT_STAT(target->stats, bytesWritten, textsLen);
+
+    if(target->kind == BUFFER_OUTPUT){
+        if(textsLen > WRITE_BUFFER_SIZE - target->bufferLen){
+            flushOutput(target);
+            if(textsLen >= WRITE_BUFFER_SIZE){
+                bool written;
+                TIME_STAT(target->stats, outputSeconds, written = writeAll(target->fd, texts, textsLen));
+                if(!written) target->failed = true;
+                return;
+            }
+        }
+        memcpy(target->buffer + target->bufferLen, texts, textsLen);
+        target->bufferLen += textsLen;
+        return;
+    }
+
+    if(target->kind == PATCH_OUTPUT){
+        //Texts that are not replaced are already in place.
+        if(texts != target->patchBase + target->patchOffset)
+            memcpy(target->patchBase + target->patchOffset, texts, textsLen);
+        target->patchOffset += textsLen;
+        return;
+    }
+
+    if(target->kind == MEMORY_OUTPUT){
+        if(target->memoryLen + textsLen > target->memoryCapacity){
+            size_t capacity = target->memoryCapacity ? target->memoryCapacity : BLOCK_SIZE;
+            while(capacity < target->memoryLen + textsLen) capacity *= 2;
+
+            char *larger = realloc(target->memory, capacity);
+            if(!larger){
+                target->failed = true;
+                return;
+            }
+            target->memory = larger;
+            target->memoryCapacity = capacity;
+        }
+        memcpy(target->memory + target->memoryLen, texts, textsLen);
+        target->memoryLen += textsLen;
+        return;
+    }
+
+    struct iovec *last = target->vecs + target->vecCount - 1;
+    if(target->vecCount && (char *)last->iov_base + last->iov_len == texts){
+        last->iov_len += textsLen;
+        return;
+    }
+
+    if(target->vecCount == IOV_BATCH) flushOutput(target);
+    target->vecs[target->vecCount].iov_base = (void *)texts;
+    target->vecs[target->vecCount++].iov_len = textsLen;
+}
+
+
+/**
+ * @brief 
+ * Writes the buffer or the iovecs gathered by an output target to its file descriptor, or hands the iovecs
+ * to its callback one by one.
+ * 
+ * @param target
+ *      Output target of the context.
+ */
+static void writeOutput(OutputTarget *target){
+    struct iovec *vecs = target->vecs;
+    int remaining = target->failed ? 0 : target->vecCount;
+
+    if(target->kind == BUFFER_OUTPUT){
+        if(!target->failed && !writeAll(target->fd, target->buffer, target->bufferLen)) target->failed = true;
+        target->bufferLen = 0;
+        return;
+    }
+
+    if(target->kind == CALLBACK_OUTPUT){
+        for(int i = 0; i < remaining && !target->failed; i++)
+            target->failed = !target->write(vecs[i].iov_base, vecs[i].iov_len, target->user);
+        remaining = 0;
+    }
+
+    while(remaining){
+        ssize_t written = writev(target->fd, vecs, remaining);
+        if(written < 0 && errno == EINTR) continue;
+        if(written <= 0){
+            target->failed = true;
+            break;
+        }
+
+        //Skips the iovecs that were written completely and trims the one that was written partially.
+        while(remaining && (size_t)written >= vecs->iov_len){
+            written -= vecs->iov_len;
+            vecs++;
+            remaining--;
+        }
+        if(remaining){
+            vecs->iov_base = (char *)vecs->iov_base + written;
+            vecs->iov_len -= written;
+        }
+    }
+    target->vecCount = 0;
+}
+
+
+/**
+ * @brief 
+ * Writes what an output target holds (see writeOutput()), timing it as the output time of the context.
+ * 
+ * @param target
+ *      Output target of the context.
+ * 
+ * @return
+ *      False if any write of the target has failed so far.
+ */
+bool flushOutput(OutputTarget *target){
+    TIME_STAT(target->stats, outputSeconds, writeOutput(target));
+    return !target->failed;
+}
+
+
+/**
+ * @brief 
+ * Writes texts to a file descriptor, resuming after partial writes.
+ * 
+ * @param fd
+ *      File descriptor of the output.
+ * 
+ * @param texts
+ *      Texts to be written.
+ * 
+ * @param textsLen
+ *      Number of characters to be written.
+ * 
+ * @return
+ *      False if the texts couldn't be written completely (e.g. the disk is full).
+ */
+bool writeAll(int fd, const char *texts, size_t textsLen){
+    while(textsLen){
+        ssize_t written = write(fd, texts, textsLen);
+        if(written < 0 && errno == EINTR) continue;
+        if(written <= 0) return false;
+        texts += written;
+        textsLen -= written;
+    }
+    return true;
+}
+
+
+/**
+ * @brief 
+ * Allocates the buffer of a BUFFER_OUTPUT target.
+ * 
+ * @note
+ *      The buffer is aligned to a page, so every full buffer is written as whole pages.
+ * 
+ * @return
+ *      Buffer of WRITE_BUFFER_SIZE bytes (freed with free()), or NULL if it couldn't be allocated.
+ */
+char *allocWriteBuffer(){
+    long pageSize = sysconf(_SC_PAGESIZE);
+    void *buffer;
+
+    if(posix_memalign(&buffer, pageSize > 0 ? pageSize : 4096, WRITE_BUFFER_SIZE)) return NULL;
+    return buffer;
+}
+
+
+/**
+ * @brief 
+ * Obtains the time of the monotonic clock, which times the input and output of fr_stats.
+ * 
+ * @return
+ *      Time in seconds.
+ */
+double statSeconds(){
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+
+/**
+ * @brief 
+ * Performs the normal find/replace function, where all existence of the search text would be replace 
+ * by the replacement text.
+ * 
+ * @note
+ *      The line is scanned with a cursor that only moves forward. Each match prints the untouched texts
+ *      between the cursor and the match followed by the replacement text, so the work is linear in the line length.
+ * 
+ * @param context
+ *      Context of the input.
+ * 
+ * @param curr_line
+ *      Line (or the beginning of a line) being read by the program. It doesn't need to be null-terminated.
+ * 
+ * @param lineLen
+ *      Length or number of characters in curr_line.
+ * 
+ * @param complete
+ *      Boolean value indicating whether curr_line reaches the end of the line.
+ * 
+ * @return
+ *      Number of characters printed in the output. When the line is incomplete, the last searchLen - 1
+ *      characters are left to be searched with the next block.
+ */
+size_t replace(fr_context *context, const char *curr_line, size_t lineLen, bool complete){
+    const fr_pattern *pattern = context->pattern;
+    size_t cursor = 0, searchLen = pattern->searchLen;
+
+    const char *word_found;
+    MatchCursor matches;
+    initMatchCursor(&matches, curr_line, lineLen, pattern->search, searchLen, pattern->plan.search, &pattern->plan.table);
+
+    //Loop until all search texts are replaced.
+    while((word_found = nextMatch(&matches, cursor))){
+        //Print all texts between the cursor and the search text + replacement text.
+        writeText(&context->output, curr_line + cursor, word_found - curr_line - cursor);
+        writeText(&context->output, pattern->replace, pattern->replaceLen);
+        cursor = word_found - curr_line + searchLen;
+        COUNT_STAT(&context->stats, candidates, 1);
+        COUNT_STAT(&context->stats, matches, 1);
+    }
+
+    //A match might start within the last searchLen - 1 characters of an incomplete line.
+    size_t end = lineLen;
+    if(!complete && lineLen - cursor >= searchLen) end = lineLen - (searchLen - 1);
+    else if(!complete) end = cursor;
+
+    writeText(&context->output, curr_line + cursor, end - cursor); //Prints all the leftover texts.
+    return end;
+}
+
+
+/**
+ * @brief
+ *      Finishes a word that continued past the end of the previous block, once its prefix was decided: the rest
+ *      of the word is dropped after a true prefix (WORD_SKIP) and printed otherwise (WORD_COPY).
+ * 
+ * @param context
+ *      Context of the input.
+ * 
+ * @param curr_line
+ *      Rest of the line, beginning with the rest of the word.
+ * 
+ * @param lineLen
+ *      Length or number of characters in curr_line.
+ * 
+ * @param complete
+ *      Boolean value indicating whether curr_line reaches the end of the line.
+ * 
+ * @return
+ *      Index right after the word. It is lineLen when the word might still continue in the next block, in which
+ *      case wordState is kept.
+ */
+static size_t finishWord(fr_context *context, const char *curr_line, size_t lineLen, bool complete){
+    size_t endOfWordIndex = updateEndIndex(&context->pattern->plan.words, curr_line, lineLen, 0);
+
+    if(context->wordState == WORD_COPY) writeText(&context->output, curr_line, endOfWordIndex);
+    if(endOfWordIndex < lineLen || complete) context->wordState = WORD_NONE;
+    return endOfWordIndex;
+}
+
+
+/**
+ * @brief
+ * Performs the prefix find/replace function, where all words with the input prefix would be
+ * replace by the replacement text.
+ * 
+ * @param context
+ *      Context of the input.
+ * 
+ * @param curr_line
+ *      Line (or the beginning of a line) being read by the program. It doesn't need to be null-terminated.
+ * 
+ * @param lineLen
+ *      Length or number of characters in curr_line.
+ * 
+ * @param complete
+ *      Boolean value indicating whether curr_line reaches the end of the line.
+ * 
+ * @return
+ *      Number of characters printed in the output.
+ */
+size_t prefixReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete){
+    /*
+    A prefix found right at the cursor always starts a word. lineStart of the context remembers whether the
+    cursor sits at the beginning of curr_line and wordBefore whether the character printed right before curr_line
+    belongs to a word, because an incomplete line is continued by the next call.
+    */
+    const fr_pattern *pattern = context->pattern;
+    const WordSet *words = &pattern->plan.words;
+    size_t prefixLen = pattern->searchLen, cursor = 0, end;
+    bool cursorIsMark = context->lineStart || context->wordState != WORD_NONE;
+    const char *prefix_found;
+
+    if(context->wordState != WORD_NONE){
+        cursor = finishWord(context, curr_line, lineLen, complete);
+        if(cursor == lineLen && !complete) return lineLen;
+    }
+
+    MatchCursor matches;
+    initMatchCursor(&matches, curr_line, lineLen, pattern->search, prefixLen, pattern->plan.search, &pattern->plan.table);
+
+    while((prefix_found = nextMatch(&matches, cursor))){
+        size_t indexOfWord = prefix_found - curr_line, endOfWordIndex = updateEndIndex(words, curr_line, lineLen, indexOfWord + prefixLen);
+
+        //Check if the prefix found is a true prefix, meaning it must be at the beginning of a word.
+        bool wordBefore = indexOfWord ? wordCharBefore(words, curr_line, 0, indexOfWord) != 0 : context->wordBefore;
+        bool truePrefix = (indexOfWord == cursor && cursorIsMark) || !wordBefore;
+        COUNT_STAT(&context->stats, candidates, 1);
+        if(truePrefix){
+            writeText(&context->output, curr_line + cursor, indexOfWord - cursor);
+            writeText(&context->output, pattern->replace, pattern->replaceLen);
+            COUNT_STAT(&context->stats, matches, 1);
+        }
+        else
+            writeText(&context->output, curr_line + cursor, endOfWordIndex - cursor);
+
+        //The word might continue in the next block, which finishes it the same way.
+        if(endOfWordIndex == lineLen && !complete){
+            context->wordState = truePrefix ? WORD_SKIP : WORD_COPY;
+            return lineLen;
+        }
+
+        cursor = endOfWordIndex;
+        cursorIsMark = true;
+    }
+
+    if(complete){
+        writeText(&context->output, curr_line + cursor, lineLen - cursor);
+        context->lineStart = true;
+        return lineLen;
+    }
+
+    //Keep the texts where a prefix might still begin.
+    end = lineLen - cursor >= prefixLen ? charStart(words, curr_line, lineLen, cursor, lineLen - (prefixLen - 1)) : cursor;
+    writeText(&context->output, curr_line + cursor, end - cursor);
+
+    context->lineStart = (end == cursor && cursorIsMark);
+    if(end) context->wordBefore = wordCharBefore(words, curr_line, 0, end) != 0;
+    return end;
+}
+
+
+/**
+ * @brief
+ * Performs the suffix find/replace function, where all words with the input suffix would be replace
+ * by the replacement text.
+ * 
+ * @param context
+ *      Context of the input.
+ * 
+ * @param curr_line
+ *      Line (or the beginning of a line) being read by the program. It doesn't need to be null-terminated.
+ * 
+ * @param lineLen
+ *      Length or number of characters in curr_line.
+ * 
+ * @param complete
+ *      Boolean value indicating whether curr_line reaches the end of the line.
+ * 
+ * @return
+ *      Number of characters printed in the output. An incomplete line is only printed up to the
+ *      beginning of its last word, so the whole word is still available to the next call.
+ */
+size_t suffixReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete){
+    const fr_pattern *pattern = context->pattern;
+    const WordSet *words = &pattern->plan.words;
+    size_t suffixLen = pattern->searchLen, cursor = 0, end;
+    const char *suffix_found;
+
+    MatchCursor matches;
+    initMatchCursor(&matches, curr_line, lineLen, pattern->search, suffixLen, pattern->plan.search, &pattern->plan.table);
+
+    while((suffix_found = nextMatch(&matches, cursor))){
+        size_t indexOfWord = suffix_found - curr_line, endOfWordIndex = updateEndIndex(words, curr_line, lineLen, indexOfWord + suffixLen);
+
+        //The word might continue in the next block.
+        if(endOfWordIndex == lineLen && !complete) break;
+
+        //Check if the suffix found is a true suffix, meaning it must be at the end of the word.
+        COUNT_STAT(&context->stats, candidates, 1);
+        if(equalPattern(curr_line + (endOfWordIndex - suffixLen), pattern->search, suffixLen, pattern->plan.fold)){
+            size_t startOfWordIndex = updateStartIndex(words, curr_line, cursor, indexOfWord);
+            writeText(&context->output, curr_line + cursor, startOfWordIndex - cursor);
+            writeText(&context->output, pattern->replace, pattern->replaceLen);
+            COUNT_STAT(&context->stats, matches, 1);
+        }
+        else writeText(&context->output, curr_line + cursor, endOfWordIndex - cursor);
+
+        cursor = endOfWordIndex;
+    }
+
+    if(complete){
+        writeText(&context->output, curr_line + cursor, lineLen - cursor);
+        return lineLen;
+    }
+
+    //Keep the texts where a suffix might still begin, extended back to the beginning of that word.
+    end = suffix_found ? (size_t)(suffix_found - curr_line) : lineLen - cursor >= suffixLen ? lineLen - (suffixLen - 1) : cursor;
+    end = updateStartIndex(words, curr_line, cursor, charStart(words, curr_line, lineLen, cursor, end));
+    writeText(&context->output, curr_line + cursor, end - cursor);
+    return end;
+}
+
+
+/**
+ * @brief
+ * Performs the prefix find/replace function with an AffixScanner, for a prefix made only of word characters (see
+ * compilePlan()).
+ *
+ * @note
+ *      The scanner only hands out the words that begin with the prefix, so a prefix in the middle of a word is
+ *      never found, walked and rejected afterwards. Every call begins at the beginning of a word or at a character
+ *      that is not part of one: an incomplete line is either printed up to the beginning of its last word, or its
+ *      last word is finished by the next call (see finishWord()).
+ *
+ * @param context
+ *      Context of the input.
+ *
+ * @param curr_line
+ *      Line (or the beginning of a line) being read by the program. It doesn't need to be null-terminated.
+ *
+ * @param lineLen
+ *      Length or number of characters in curr_line.
+ *
+ * @param complete
+ *      Boolean value indicating whether curr_line reaches the end of the line.
+ *
+ * @return
+ *      Number of characters printed in the output.
+ */
+size_t prefixWordsReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete){
+    const fr_pattern *pattern = context->pattern;
+    const WordSet *words = &pattern->plan.words;
+    size_t prefixLen = pattern->searchLen, cursor = 0, from, start;
+    AffixScanner scanner;
+
+    if(context->wordState != WORD_NONE){
+        cursor = finishWord(context, curr_line, lineLen, complete);
+        if(cursor == lineLen && !complete) return lineLen;
+    }
+
+    initAffixScanner(&scanner, curr_line, lineLen, pattern->search, prefixLen, false, pattern->plan.fold, &pattern->plan.wordClasses);
+    for(from = cursor; (start = nextAffixWord(&scanner, from)) < lineLen;){
+        //The scanner only knows the word bytes, so a prefix right after a UTF-8 character may be inside a word.
+        from = start + 1;
+        if(words->utf8 && start && (unsigned char)curr_line[start - 1] >= 0x80 && wordCharBefore(words, curr_line, 0, start))
+            continue;
+
+        size_t endOfWordIndex = updateEndIndex(words, curr_line, lineLen, start + prefixLen);
+
+        writeText(&context->output, curr_line + cursor, start - cursor);
+        writeText(&context->output, pattern->replace, pattern->replaceLen);
+        COUNT_STAT(&context->stats, candidates, 1);
+        COUNT_STAT(&context->stats, matches, 1);
+
+        //The word might continue in the next block, which drops the rest of it.
+        if(endOfWordIndex == lineLen && !complete){
+            context->wordState = WORD_SKIP;
+            return lineLen;
+        }
+        cursor = from = endOfWordIndex;
+    }
+
+    //A last word shorter than the prefix might still grow into one, and a longer one never will.
+    size_t end = complete ? lineLen : updateStartIndex(words, curr_line, cursor, lineLen);
+    if(lineLen - end >= prefixLen){
+        context->wordState = WORD_COPY;
+        end = lineLen;
+    }
+    writeText(&context->output, curr_line + cursor, end - cursor);
+    return end;
+}
+
+
+/**
+ * @brief
+ * Performs the suffix find/replace function with an AffixScanner, for a suffix made only of word characters (see
+ * compilePlan()).
+ *
+ * @note
+ *      The scanner only hands out the words that end with the suffix, so the line is never searched for the suffix
+ *      and only the words that are replaced are walked back to their beginning.
+ *
+ * @param context
+ *      Context of the input.
+ *
+ * @param curr_line
+ *      Line (or the beginning of a line) being read by the program. It doesn't need to be null-terminated.
+ *
+ * @param lineLen
+ *      Length or number of characters in curr_line.
+ *
+ * @param complete
+ *      Boolean value indicating whether curr_line reaches the end of the line.
+ *
+ * @return
+ *      Number of characters printed in the output. As with suffixReplace(), an incomplete line is only printed up
+ *      to the beginning of its last word.
+ */
+size_t suffixWordsReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete){
+    const fr_pattern *pattern = context->pattern;
+    const WordSet *words = &pattern->plan.words;
+    size_t suffixLen = pattern->searchLen, cursor = 0, from, start;
+    AffixScanner scanner;
+
+    initAffixScanner(&scanner, curr_line, lineLen, pattern->search, suffixLen, true, pattern->plan.fold, &pattern->plan.wordClasses);
+    for(from = cursor; (start = nextAffixWord(&scanner, from)) < lineLen;){
+        size_t after = start + suffixLen;
+
+        //The word might continue in the next block.
+        if(after == lineLen && !complete) break;
+
+        //The scanner only knows the word bytes, so a suffix right before a UTF-8 character may be inside a word.
+        from = start + 1;
+        if(words->utf8 && after < lineLen && (unsigned char)curr_line[after] >= 0x80 && wordCharAt(words, curr_line, lineLen, after))
+            continue;
+
+        size_t startOfWordIndex = updateStartIndex(words, curr_line, cursor, start);
+        writeText(&context->output, curr_line + cursor, startOfWordIndex - cursor);
+        writeText(&context->output, pattern->replace, pattern->replaceLen);
+        COUNT_STAT(&context->stats, candidates, 1);
+        COUNT_STAT(&context->stats, matches, 1);
+        cursor = from = after;
+    }
+
+    size_t end = complete ? lineLen : updateStartIndex(words, curr_line, cursor, lineLen);
+    writeText(&context->output, curr_line + cursor, end - cursor);
+    return end;
+}
+
+
+/**
+ * @brief
+ * Performs the glob find/replace function, where all words that match the glob of the w flag (ex. *ab*cd*)
+ * would be replaced by the replacement text.
+ *
+ * @note
+ *      Only the words that contain the longest run of plain characters of the glob (see fr_pattern) are matched,
+ *      each by a single pass of matchWordGlob(), and the search goes on from the end of the word. When the glob
+ *      has no plain character, every word is matched.
+ *
+ * @param context
+ *      Context of the input.
+ *
+ * @param curr_line
+ *      Line (or the beginning of a line) being read by the program. It doesn't need to be null-terminated.
+ *
+ * @param lineLen
+ *      Length or number of characters in curr_line.
+ *
+ * @param complete
+ *      Boolean value indicating whether curr_line reaches the end of the line.
+ *
+ * @return
+ *      Number of characters printed in the output. As with suffixReplace(), an incomplete line is only printed up
+ *      to the beginning of its last word.
+ */
+size_t globReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete){
+    const fr_pattern *pattern = context->pattern;
+    const WordSet *words = &pattern->plan.words;
+    size_t literalLen = pattern->searchLen, cursor = 0, end = SIZE_MAX;
+
+    MatchCursor matches;
+    if(literalLen) initMatchCursor(&matches, curr_line, lineLen, pattern->search, literalLen, pattern->plan.search, &pattern->plan.table);
+
+    while(true){
+        size_t indexOfWord = cursor;
+        if(literalLen){
+            const char *literal_found = nextMatch(&matches, cursor);
+            indexOfWord = literal_found ? (size_t)(literal_found - curr_line) : lineLen;
+        }
+        else while(indexOfWord < lineLen && !wordCharAt(words, curr_line, lineLen, indexOfWord)) indexOfWord++;
+        if(indexOfWord == lineLen) break;
+
+        size_t startOfWordIndex = updateStartIndex(words, curr_line, cursor, indexOfWord),
+            endOfWordIndex = updateEndIndex(words, curr_line, lineLen, indexOfWord + literalLen);
+
+        //The word might continue in the next block.
+        if(endOfWordIndex == lineLen && !complete){
+            end = startOfWordIndex;
+            break;
+        }
+
+        COUNT_STAT(&context->stats, candidates, 1);
+        if(matchWordGlob(&pattern->glob, curr_line + startOfWordIndex, endOfWordIndex - startOfWordIndex)){
+            writeText(&context->output, curr_line + cursor, startOfWordIndex - cursor);
+            writeText(&context->output, pattern->replace, pattern->replaceLen);
+            COUNT_STAT(&context->stats, matches, 1);
+        }
+        else writeText(&context->output, curr_line + cursor, endOfWordIndex - cursor);
+
+        cursor = endOfWordIndex;
+    }
+
+    if(complete){
+        writeText(&context->output, curr_line + cursor, lineLen - cursor);
+        return lineLen;
+    }
+
+    //Keep the texts where the plain characters might still begin, extended back to the beginning of that word.
+    if(end == SIZE_MAX){
+        end = lineLen - cursor >= literalLen ? lineLen - (literalLen ? literalLen - 1 : 0) : cursor;
+        end = updateStartIndex(words, curr_line, cursor, charStart(words, curr_line, lineLen, cursor, end));
+    }
+    writeText(&context->output, curr_line + cursor, end - cursor);
+    return end;
+}
+
+
+/**
+ * @brief
+ * Applies all rules of the rules file in a single scan. At every position the leftmost match wins, and the
+ * longest search text wins among matches that start at the same position.
+ * 
+ * @note
+ *      Each rule keeps the meaning of its mode: normal rules are replaced wherever they are found, while
+ *      prefix/suffix rules go through the same word checks as prefixReplace() and suffixReplace().
+ * 
+ * @param context
+ *      Context of the input.
+ * 
+ * @param curr_line
+ *      Line (or the beginning of a line) being read by the program. It doesn't need to be null-terminated.
+ * 
+ * @param lineLen
+ *      Length or number of characters in curr_line.
+ * 
+ * @param complete
+ *      Boolean value indicating whether curr_line reaches the end of the line.
+ * 
+ * @return
+ *      Number of characters printed in the output.
+ */
+size_t multiReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete){
+    //See prefixReplace() for the meaning of lineStart and wordBefore.
+    const RuleSet *rules = &context->pattern->rules;
+    const WordSet *words = &context->pattern->plan.words;
+    size_t cursor = 0, start, end;
+    bool cursorIsMark = context->lineStart || context->wordState != WORD_NONE;
+    int rule;
+
+    if(context->wordState != WORD_NONE){
+        cursor = finishWord(context, curr_line, lineLen, complete);
+        if(cursor == lineLen && !complete) return lineLen;
+    }
+
+    while(findLeftmostLongest(rules, curr_line, lineLen, cursor, complete, &start, &rule) == MATCH_FOUND){
+        const Rule *found = rules->rules + rule;
+        size_t endOfWordIndex = start + found->searchLen;
+
+        if(found->mode == 0){
+            writeText(&context->output, curr_line + cursor, start - cursor);
+            writeText(&context->output, found->replace, found->replaceLen);
+            COUNT_STAT(&context->stats, candidates, 1);
+            COUNT_STAT(&context->stats, matches, 1);
+        }
+        else{
+            endOfWordIndex = updateEndIndex(words, curr_line, lineLen, endOfWordIndex);
+
+            //The word might continue in the next block. Only a suffix needs to see its end.
+            bool incomplete = endOfWordIndex == lineLen && !complete;
+            if(incomplete && found->mode == 2) break;
+
+            bool wordBefore = start ? wordCharBefore(words, curr_line, 0, start) != 0 : context->wordBefore;
+            bool truePrefix = found->mode == 1 && ((start == cursor && cursorIsMark) || !wordBefore),
+                trueSuffix = found->mode == 2 && equalPattern(curr_line + (endOfWordIndex - found->searchLen), found->search, found->searchLen, rules->ignoreCase);
+
+            COUNT_STAT(&context->stats, candidates, 1);
+            if(truePrefix || trueSuffix){
+                size_t startOfWordIndex = truePrefix ? start : updateStartIndex(words, curr_line, cursor, start);
+                writeText(&context->output, curr_line + cursor, startOfWordIndex - cursor);
+                writeText(&context->output, found->replace, found->replaceLen);
+                COUNT_STAT(&context->stats, matches, 1);
+            }
+            else writeText(&context->output, curr_line + cursor, endOfWordIndex - cursor);
+
+            if(incomplete){
+                context->wordState = truePrefix ? WORD_SKIP : WORD_COPY;
+                return lineLen;
+            }
+        }
+
+        cursor = endOfWordIndex;
+        cursorIsMark = true;
+    }
+
+    if(complete){
+        writeText(&context->output, curr_line + cursor, lineLen - cursor);
+        context->lineStart = true;
+        return lineLen;
+    }
+
+    //start is the first position where a match might still begin. Suffix rules need the whole word as well.
+    end = charStart(words, curr_line, lineLen, cursor, start);
+    if(rules->hasSuffixRules) end = updateStartIndex(words, curr_line, cursor, end);
+    writeText(&context->output, curr_line + cursor, end - cursor);
+
+    context->lineStart = (end == cursor && cursorIsMark);
+    if(end) context->wordBefore = wordCharBefore(words, curr_line, 0, end) != 0;
+    return end;
+}
+
+
+/**
+ * @brief
+ *      Prints the replacement text of a regex match, with the texts of the groups it refers to.
+ *
+ * @param context
+ *      Context of the input.
+ *
+ * @param curr_line
+ *      Line of the match.
+ *
+ * @param groups
+ *      Offsets of the groups of the match (see regexGroups()). Only the whole match is set when the replacement
+ *      text refers to no other group.
+ */
+static void writeRegexReplacement(fr_context *context, const char *curr_line, const size_t *groups){
+    const Regex *regex = &context->pattern->regex;
+
+    for(int p = 0; p < regex->partCount; p++){
+        const ReplacePart *part = regex->parts + p;
+        if(part->group < 0) writeText(&context->output, part->texts, part->textsLen);
+        else if(groups[2 * part->group] != SIZE_MAX && groups[2 * part->group + 1] != SIZE_MAX){
+            writeText(&context->output, curr_line + groups[2 * part->group],
+                groups[2 * part->group + 1] - groups[2 * part->group]);
+        }
+    }
+}
+
+
+/**
+ * @brief
+ *      Replaces all leftmost-longest matches of the regex in a line (E flag).
+ *
+ * @note
+ *      The first match of the literal prefix of the regex (see fr_pattern) tells where the first match may begin,
+ *      and a line without it is printed as it is. The reverse DFA then marks every offset after it where a match
+ *      begins, and each match is read by the forward DFA from the first marked offset after the previous match.
+ *      As with sed, an empty match right after a match is skipped, and the character after an empty match is
+ *      printed before the next match is looked for.
+ *      Since a match may end anywhere in the line, an incomplete line is only printed up to the first match of
+ *      the literal prefix (or up to its last searchLen - 1 characters when there is none), and lineStart of the
+ *      context tells the next call that its texts continue the line. The rest of the line is held until its end,
+ *      so a long line of a regex without a literal prefix is held in memory as a whole.
+ *
+ * @param context
+ *      Context of the input.
+ *
+ * @param curr_line
+ *      Line being read by the program.
+ *
+ * @param lineLen
+ *      Length or number of characters in curr_line.
+ *
+ * @param complete
+ *      Boolean value indicating whether curr_line reaches the end of the line.
+ *
+ * @return
+ *      Number of characters printed in the output.
+ */
+size_t regexReplace(fr_context *context, const char *curr_line, size_t lineLen, bool complete){
+    const fr_pattern *pattern = context->pattern;
+    size_t textsLen = lineLen - (lineLen && curr_line[lineLen - 1] == '\n'), cursor = 0, from = 0, start;
+    size_t lastEnd = SIZE_MAX, groups[2 * REGEX_GROUPS];
+    bool lineStart = context->lineStart;
+
+    if(pattern->searchLen){
+        MatchCursor matches;
+        initMatchCursor(&matches, curr_line, textsLen, pattern->search, pattern->searchLen, pattern->plan.search,
+            &pattern->plan.table);
+        const char *found = nextMatch(&matches, 0);
+        from = found ? (size_t)(found - curr_line) : SIZE_MAX;
+    }
+
+    //No match begins before the first match of the prefix, which might start within the last searchLen - 1
+    //characters of an incomplete line.
+    if(!complete){
+        size_t end = from;
+        if(!pattern->searchLen) end = 0;
+        else if(from == SIZE_MAX) end = lineLen >= pattern->searchLen ? lineLen - (pattern->searchLen - 1) : 0;
+        writeText(&context->output, curr_line, end);
+        if(end) context->lineStart = false;
+        return end;
+    }
+    context->lineStart = true;
+
+    //The DFA states of the context are only allocated once a line may hold a match.
+    if(from != SIZE_MAX && !context->regexCache && !(context->regexCache = newRegexCache(&pattern->regex))){
+        context->output.failed = true;
+        return lineLen;
+    }
+    if(from != SIZE_MAX && !findRegexStarts(context->regexCache, curr_line, textsLen, from, lineStart)){
+        context->output.failed = true;
+        return lineLen;
+    }
+
+    while(from != SIZE_MAX && (start = nextRegexStart(context->regexCache, from)) != SIZE_MAX){
+        size_t end = longestRegexMatch(context->regexCache, curr_line, textsLen, start);
+        COUNT_STAT(&context->stats, candidates, 1);
+
+        //An empty match right after a match is not replaced.
+        if(end == SIZE_MAX || (end == start && start == lastEnd)){
+            from = start + 1;
+            continue;
+        }
+
+        groups[0] = start;
+        groups[1] = end;
+        if(pattern->regex.groupsUsed) regexGroups(context->regexCache, curr_line, textsLen, start, end, groups);
+
+        writeText(&context->output, curr_line + cursor, start - cursor);
+        writeRegexReplacement(context, curr_line, groups);
+        COUNT_STAT(&context->stats, matches, 1);
+
+        cursor = lastEnd = end;
+        from = end > start ? end : start + 1;
+    }
+
+    writeText(&context->output, curr_line + cursor, lineLen - cursor);
+    return lineLen;
+}
+
+
+/**
+ * @brief 
+ *      Obtains the index that indicates the ending of a word.
+ *      For example, the ending index for "apple." is 5.
+ * 
+ * @param words
+ *      Characters that belong to a word (see SearchPlan).
+ * 
+ * @param curr_line
+ *      Line being read by the program.
+ * 
+ * @param lineLen
+ *      Length or number of characters in the current line.
+ * 
+ * @param endIndex
+ *      Initial ending index.
+ * 
+ * @return
+ *      Updated ending index.
+ */
+size_t updateEndIndex(const WordSet *words, const char *curr_line, size_t lineLen, size_t endIndex){
+    for(size_t charLen; endIndex < lineLen && (charLen = wordCharAt(words, curr_line, lineLen, endIndex)); endIndex += charLen);
+    return endIndex;
+}
+
+
+/**
+ * @brief 
+ *      Obtains the index that indicates the beginning of a word.
+ *      For example, starting index for ". Apple" is 2.
+ * 
+ * @param words
+ *      Characters that belong to a word (see SearchPlan).
+ * 
+ * @param curr_line 
+ *      Line being read by the program.
+ * 
+ * @param cursor
+ *      Index where the unprinted texts begin. The word never extends before it.
+ * 
+ * @param startIndex
+ *      Initial staring index.
+ * 
+ * @return
+ *      Updated starting index.
+ */
+size_t updateStartIndex(const WordSet *words, const char *curr_line, size_t cursor, size_t startIndex){
+    for(size_t charLen; startIndex > cursor && (charLen = wordCharBefore(words, curr_line, cursor, startIndex)); startIndex -= charLen);
+    return startIndex;
+}
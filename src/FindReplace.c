@@ -10,23 +10,45 @@
 #include "FindReplace.h"
 
 extern char *optarg;
-int searchLen;
 
-char search_text[MAX_TEXT_LEN + 1], replace_text[MAX_TEXT_LEN + 1];
+_Thread_local FILE *inputFile, *outputFile;
 
-FILE *inputFile, *outputFile;
+//Number of worker threads requested with the j flag
+int threadCount = 1;
+
+/*
+searchOptions collects the search spec of the s/r/l/w/f flags, which is compiled once into compiledPattern
+(see libfindreplace.h).
+*/
+fr_options searchOptions;
+fr_pattern *compiledPattern;
+
+//Manifest file indicated by the m flag
+char *manifestPath;
+
+//Input file whose line index is used by the l flag (x flag), or NULL
+char *indexedInput;
+
+//JSON file receiving the counters of the --stats flag, or NULL for stderr
+char *statsPath;
+
+//Buffers of streamFindReplace(), reused by every input file
+_Thread_local char *streamBuffer, *writeBuffer;
+_Thread_local size_t streamCapacity;
 
 /*
 checkFlags checks if the user enters a specific flag.
-checkFlags = {s flag, r flag, l flag, w flag, dublicate flag}
+checkFlags = {s flag, r flag, l flag, w flag, dublicate flag, t flag, j flag, f flag, b flag, m flag, R flag, x flag,
+    stats flag, E flag, i flag, u flag}
 */
-bool checkFlags[] = {false, false, false, false, false};
+bool checkFlags[] = {false, false, false, false, false, false, false, false, false, false, false, false, false, false,
+    false, false};
 
 /*
 argErrors indicates if an argument is missing/invalid for a specific flag.
-argErrors = {s_flag_arg, r_flag_arg, l_flag_r}
+argErrors = {s_flag_arg, r_flag_arg, l_flag_r, f_flag_arg, m_flag_arg, j_flag_arg}
 */
-bool argErrors[] = {false, false, false, false};
+bool argErrors[] = {false, false, false, false, false, false};
 
 
 int main(int argc, char *argv[]){
@@ -37,40 +59,69 @@ int main(int argc, char *argv[]){
     - s flag argument
     - r flag
     - r flag argument
-    - input file
-    - output file
+    - input file ("-" for stdin)
+    - output file ("-" for stdout)
+
+    With the f flag, the s/r flags (and their arguments) may be replaced by the f flag and the rules file.
+    With the b/m/R flags, the input and output files are replaced by the files to be edited in place.
     */
-    if(argc < 7) return MISSING_ARGUMENT;
+    if(argc < 5) return MISSING_ARGUMENT;
     
-    /*
-    start_end_lines indicates the range of the replacement process
-    start_end_lines = {starting line num, ending line num}
-    */
-    int start_end_lines[] = {1, INT_MAX};
+    scanArgs(argc, argv);
 
-    scanArgs(argc, argv, start_end_lines);
+    bool batch = checkFlags[8] || checkFlags[9] || checkFlags[10];
+    if(!batch && argc < 7 && !checkFlags[7]) return MISSING_ARGUMENT;
+    if(batch && ((optind == argc && !checkFlags[9]) || argErrors[4])) return MISSING_ARGUMENT;
 
     int error;
 
-    searchLen = strlen(search_text);
+    if(batch) error = checkFlags[4] ? DUPLICATE_ARGUMENT : checkArgErrors();
+    else error = checkErrors(argv[argc - 2], argv[argc - 1]);
 
-    if((error = checkErrors(argv[argc - 2], argv[argc - 1]))) return error;
-    
-    /*
-    mode = 0: replaces all search_text.
+    if(error){
+        finishCompression(error);
+        discardInPlace();
+        return error;
+    }
 
-    mode = 1: replaces all texts with a prefix of search_text.
+    //Without the j flag, the R flag uses one worker per CPU.
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int treeWorkers = !checkFlags[10] ? 0 : checkFlags[6] ? threadCount : cpus < 1 ? 1 : cpus < MAX_THREADS ? cpus : MAX_THREADS;
 
-    mode >= 2: replaces all texts with a suffix of search_text.
-    */
-    int mode = 0;
-    if(search_text[searchLen - 1] == '*') mode = 1;
-    else if(search_text[0] == '*') mode = 2;
-
-    findReplace(mode, start_end_lines);
-    fclose(inputFile);
-    fclose(outputFile);
-    return 0;
+    struct timespec started, finished;
+    const char *inputPath;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    //The line index is only kept for a named input file, and only helps the l flag.
+    if(checkFlags[11] && checkFlags[2] && !batch && strcmp(argv[argc - 2], "-")) indexedInput = argv[argc - 2];
+
+    size_t bytesRead;
+    if(batch){
+        inputPath = "batch";
+        error = batchFindReplace(compiledPattern, argv + optind, argc - optind, manifestPath, treeWorkers, &bytesRead);
+    }
+    else error = findReplace(compiledPattern, threadCount, &inputPath, &bytesRead);
+
+    //Reports the throughput of the input path that was used, and the counters of the engine.
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    double seconds = (finished.tv_sec - started.tv_sec) + (finished.tv_nsec - started.tv_nsec) / 1e9;
+    if(checkFlags[5])
+        fprintf(stderr, "%s input: %zu bytes in %.6f s (%.3f GB/s)\n", inputPath, bytesRead, seconds,
+            seconds > 0 ? bytesRead / seconds / 1e9 : 0.0);
+    if(checkFlags[12] && !printStats(statsPath, inputPath, bytesRead, seconds))
+        fprintf(stderr, "stats: %s couldn't be written\n", statsPath);
+
+    if(!batch){
+        error = finishCompression(error);
+        if(inPlacePath) error = finishInPlace(error);
+        else if(fclose(outputFile) && !error) error = OUTPUT_WRITE_FAILED;
+        fclose(inputFile);
+    }
+    fr_free(compiledPattern);
+    releaseStreamBuffer();
+    free(includeGlobs.globs);
+    free(excludeGlobs.globs);
+    return error;
 }
 
 
@@ -83,16 +134,14 @@ int main(int argc, char *argv[]){
  * 
  * @param argv 
  *      Array storing the command line arguments.
- * 
- * @param start_end_lines 
- *      Array containing the starting/ending line numbers.
  */
-void scanArgs(const int argc, char* const* argv, int *start_end_lines){
+void scanArgs(const int argc, char* const* argv){
     extern int opterr, optopt;
+    static const struct option longOptions[] = {{"stats", optional_argument, NULL, 'S'}, {NULL, 0, NULL, 0}};
     int option;
     opterr = 0;
 
-    while((option = getopt(argc, argv, "s:r:l:w")) != -1){
+    while((option = getopt_long(argc, argv, "s:r:l:wEiutj:f:bm:RI:X:x", longOptions, NULL)) != -1){
         switch(option){
             case 's': {
                 srFlag(checkFlags, argErrors, true);
@@ -103,13 +152,65 @@ void scanArgs(const int argc, char* const* argv, int *start_end_lines){
                 break;
             }
             case 'l': {
-                lFlag(start_end_lines);
+                lFlag();
                 break;
             }
             case 'w': {
                 wFlag();
                 break;
             }
+            case 'E': {
+                EFlag();
+                break;
+            }
+            case 'i': {
+                iFlag();
+                break;
+            }
+            case 'u': {
+                uFlag();
+                break;
+            }
+            case 't': {
+                tFlag();
+                break;
+            }
+            case 'j': {
+                jFlag();
+                break;
+            }
+            case 'f': {
+                fFlag();
+                break;
+            }
+            case 'b': {
+                bFlag();
+                break;
+            }
+            case 'm': {
+                mFlag();
+                break;
+            }
+            case 'R': {
+                RFlag();
+                break;
+            }
+            case 'I': {
+                addGlob(&includeGlobs, optarg);
+                break;
+            }
+            case 'X': {
+                addGlob(&excludeGlobs, optarg);
+                break;
+            }
+            case 'x': {
+                xFlag();
+                break;
+            }
+            case 'S': {
+                statsFlag();
+                break;
+            }
         }
     }
 }
@@ -128,7 +229,7 @@ void scanArgs(const int argc, char* const* argv, int *start_end_lines){
  *      Boolean value indicating whether the function is dealing with a s flag.
  * 
  * @note
- *      Function initializes search and replacement texts if no error is encountered.
+ *      Function initializes the search and replacement texts of searchOptions if no error is encountered.
  */
 void srFlag(bool *srFlags, bool *argError, bool s_flag){
     if(*srFlags){
@@ -143,14 +244,13 @@ void srFlag(bool *srFlags, bool *argError, bool s_flag){
         return;
     }
 
-    if(!optarg || optarg[0] == '-'){
+    if(!optarg || optarg[0] == '-' || (s_flag && !optarg[0])){
         *argError = true;
         return;
     }
 
-    if(s_flag) sprintf(search_text, "%s", optarg);
-    else sprintf(replace_text, "%s", optarg);
-
+    if(s_flag) searchOptions.search = optarg;
+    else searchOptions.replace = optarg;
 
     *srFlags = true;
 }
@@ -161,12 +261,9 @@ void srFlag(bool *srFlags, bool *argError, bool s_flag){
  *      Indicates a l flag is scanned or a duplicate flag has occurred. 
  * 
  * @note
- *      If there is no duplicate, it initializes the starting/ending line numbers.
- * 
- * @param start_end_lines
- *      Array containing the starting/ending line numbers.
+ *      If there is no duplicate, it initializes the starting/ending line numbers of searchOptions.
  */
-void lFlag(int *start_end_lines){
+void lFlag(){
     if(checkFlags[2]){
         checkFlags[2] = true;
         return;
@@ -187,8 +284,9 @@ void lFlag(int *start_end_lines){
         return;
     }
 
-    start_end_lines[0] = start;
-    start_end_lines[1] = end;
+    searchOptions.startLine = start;
+    searchOptions.endLine = end;
+    searchOptions.lineRange = true;
     checkFlags[2] = true;
 }
 
@@ -199,7 +297,203 @@ void lFlag(int *start_end_lines){
  */
 void wFlag(){
     if(checkFlags[3]) checkFlags[4] = true;
-    else checkFlags[3] = true;
+    else checkFlags[3] = searchOptions.wildcard = true;
+}
+
+
+/**
+ * @brief 
+ *      Indicates an E flag is scanned or a duplicate flag has occurred.
+ * 
+ * @note
+ *      The E flag reads the search text as an extended regular expression (see Regex.c).
+ */
+void EFlag(){
+    if(checkFlags[13]) checkFlags[4] = true;
+    else checkFlags[13] = searchOptions.regex = true;
+}
+
+
+/**
+ * @brief 
+ *      Indicates an i flag is scanned or a duplicate flag has occurred.
+ * 
+ * @note
+ *      The i flag matches the search texts, rules and regexes whatever the case of the ASCII letters.
+ */
+void iFlag(){
+    if(checkFlags[14]) checkFlags[4] = true;
+    else checkFlags[14] = searchOptions.ignoreCase = true;
+}
+
+
+/**
+ * @brief 
+ *      Indicates a u flag is scanned or a duplicate flag has occurred.
+ * 
+ * @note
+ *      The u flag reads the input as UTF-8, so the words of the prefix/suffix modes and of the globs take in the
+ *      Unicode letters, marks and digits.
+ */
+void uFlag(){
+    if(checkFlags[15]) checkFlags[4] = true;
+    else checkFlags[15] = searchOptions.utf8 = true;
+}
+
+
+/**
+ * @brief 
+ *      Indicates a t flag is scanned or a duplicate flag has occurred.
+ * 
+ * @note
+ *      The t flag prints the throughput of the find/replace function in stderr.
+ */
+void tFlag(){
+    if(checkFlags[5]) checkFlags[4] = true;
+    else checkFlags[5] = true;
+}
+
+
+/**
+ * @brief 
+ *      Indicates a j flag is scanned or a duplicate flag has occurred.
+ * 
+ * @note
+ *      If there is no duplicate, it initializes threadCount. An argument that is not a positive number (ex. abc,
+ *      0, 4x, -2) is invalid, while one that looks like another flag is left for getopt to scan and the default
+ *      thread count is kept.
+ */
+void jFlag(){
+    extern int optind;
+
+    if(checkFlags[6]){
+        checkFlags[4] = true;
+        return;
+    }
+    checkFlags[6] = true;
+
+    if(optarg[0] == '-' && !isdigit((unsigned char)optarg[1])){
+        optind--;
+        return;
+    }
+
+    char *end;
+    long count = strtol(optarg, &end, 10);
+    if(!isdigit((unsigned char)optarg[0]) || *end || count <= 0){
+        argErrors[5] = true;
+        return;
+    }
+    threadCount = count < MAX_THREADS ? count : MAX_THREADS;
+}
+
+
+/**
+ * @brief 
+ *      Indicates a f flag is scanned or a duplicate flag has occurred.
+ * 
+ * @note
+ *      If there is no duplicate, it initializes the rules file of searchOptions. The rules are loaded when the
+ *      pattern is compiled (see checkArgErrors()).
+ */
+void fFlag(){
+    if(checkFlags[7]){
+        checkFlags[4] = true;
+        return;
+    }
+
+    if(!optarg || optarg[0] == '-'){
+        argErrors[3] = true;
+        return;
+    }
+
+    searchOptions.rulesPath = optarg;
+    checkFlags[7] = true;
+}
+
+
+/**
+ * @brief 
+ *      Indicates a b flag is scanned or a duplicate flag has occurred.
+ * 
+ * @note
+ *      The b flag edits every file that follows the flags in place (see Batch.c).
+ */
+void bFlag(){
+    if(checkFlags[8]) checkFlags[4] = true;
+    else checkFlags[8] = true;
+}
+
+
+/**
+ * @brief 
+ *      Indicates a m flag is scanned or a duplicate flag has occurred.
+ * 
+ * @note
+ *      The m flag edits every file listed in the manifest file in place, "-" reads the list from stdin.
+ */
+void mFlag(){
+    extern int optind;
+
+    if(checkFlags[9]){
+        checkFlags[4] = true;
+        return;
+    }
+    checkFlags[9] = true;
+
+    //The next flag was taken as the argument, so it is scanned again.
+    if(optarg[0] == '-' && optarg[1]){
+        argErrors[4] = true;
+        optind--;
+        return;
+    }
+
+    manifestPath = optarg;
+}
+
+
+/**
+ * @brief 
+ *      Indicates a R flag is scanned or a duplicate flag has occurred.
+ * 
+ * @note
+ *      The R flag edits every file under the directories of the batch in place, on a pool of worker
+ *      threads (see TreeWalk.c). The I/X flags choose the files by their names.
+ */
+void RFlag(){
+    if(checkFlags[10]) checkFlags[4] = true;
+    else checkFlags[10] = true;
+}
+
+
+/**
+ * @brief 
+ *      Indicates a x flag is scanned or a duplicate flag has occurred.
+ * 
+ * @note
+ *      The x flag keeps a line index beside the input file, so the l flag skips the lines before its range
+ *      on later runs (see LineIndex.c). It has no effect without the l flag or on a batch.
+ */
+void xFlag(){
+    if(checkFlags[11]) checkFlags[4] = true;
+    else checkFlags[11] = true;
+}
+
+
+/**
+ * @brief 
+ *      Indicates a --stats flag is scanned or a duplicate flag has occurred.
+ * 
+ * @note
+ *      The counters of the engine are printed to stderr at exit, or written as a JSON object to the file of
+ *      --stats=FILE (see Stats.c).
+ */
+void statsFlag(){
+    if(checkFlags[12]){
+        checkFlags[4] = true;
+        return;
+    }
+    checkFlags[12] = true;
+    statsPath = optarg;
 }
 
 
@@ -225,7 +519,11 @@ int checkErrors(char *input_file, char *output_file){
         4. S_ARGUMENT_MISSING
         5. R_ARGUMENT_MISSING
         7. L_ARGUMENT_INVALID
-        8. WILDCARD_INVALID
+        8. RULES_FILE_INVALID
+        9. REGEX_INVALID
+        10. WILDCARD_INVALID
+
+    With the f flag, the s/r flags are optional but must be entered together.
      */
     if(checkFlags[4]) return DUPLICATE_ARGUMENT;
 
@@ -233,11 +531,32 @@ int checkErrors(char *input_file, char *output_file){
 
     if(!inputFile) return INPUT_FILE_MISSING;
     if(!outputFile) return OUTPUT_FILE_UNWRITABLE;
-    if(!checkFlags[0] || argErrors[0]) return S_ARGUMENT_MISSING;
-    if(!checkFlags[1] || argErrors[1]) return R_ARGUMENT_MISSING;
+    return checkArgErrors();
+}
+
+
+/**
+ * @brief 
+ *      Returns an error code for the arguments of the s/r/l/f/w flags, following checkErrors(), and compiles
+ *      them into compiledPattern.
+ * 
+ * @note
+ *      In batch mode (b/m flags), these are the only errors checked before the files are processed.
+ * @note
+ *      The regex of the E flag (REGEX_INVALID), the rules file (RULES_FILE_INVALID) and the w flag (WILDCARD_INVALID)
+ *      are checked by fr_compile().
+ * 
+ * @return
+ *      Error code if an error is encountered, otherwise 0.
+ */
+int checkArgErrors(){
+    bool rulesOnly = checkFlags[7] && !checkFlags[0] && !checkFlags[1] && !argErrors[0] && !argErrors[1];
+    if(!rulesOnly && (!checkFlags[0] || argErrors[0])) return S_ARGUMENT_MISSING;
+    if(!rulesOnly && (!checkFlags[1] || argErrors[1])) return R_ARGUMENT_MISSING;
     if(argErrors[2]) return L_ARGUMENT_INVALID;
-    if(checkFlags[3]) return checkSearchTextForW();
-    return 0;
+    if(argErrors[5]) return J_ARGUMENT_INVALID;
+    if(argErrors[3]) return RULES_FILE_INVALID;
+    return fr_compile(&searchOptions, &compiledPattern);
 }
 
 
@@ -251,245 +570,326 @@ int checkErrors(char *input_file, char *output_file){
  *      String indicating the output file.
  * 
  * @note
- *      When both inputFile and outputFile point to the same file, inputFile would be modified to point to 
- *      a temporary file that contains the same info as the original pointed file.
+ *      When both input and output indicate the same file, the file is edited in place: outputFile points to
+ *      a temporary file next to it, which replaces it once the output is complete (see InPlace.c).
+ * @note
+ *      "-" indicates stdin as the input and stdout as the output. Neither is ever seeked, so they may be pipes.
+ * @note
+ *      A gzip/zstd compressed input is decompressed on a reader thread, and an output named *.gz or *.zst is
+ *      compressed on a writer thread (see Compression.c).
 */
 void obtainFiles(char *input, char *output){
-    inputFile = fopen(input, "r");
+    bool standardInput = !strcmp(input, "-"), standardOutput = !strcmp(output, "-");
 
-    if(!strcmp(input, output)){
-        FILE *tempFile = tmpfile();
-        char line[MAX_LINE];
+    inputFile = standardInput ? stdin : fopen(input, "r");
+    if(inputFile && !startDecompression()){
+        fclose(inputFile);
+        inputFile = NULL;
+    }
 
-        while(fgets(line, MAX_LINE, inputFile)) fputs(line, tempFile);
+    if(standardOutput) outputFile = stdout;
+    else if(inputFile && !standardInput && sameFile(input, output)) outputFile = openSiblingTemp(output);
+    else outputFile = fopen(output, "w");
 
-        rewind(tempFile);
-        inputFile = tempFile;
+    if(outputFile && !standardOutput && !startCompression(output)){
+        if(inPlacePath) discardInPlace();
+        else fclose(outputFile);
+        outputFile = NULL;
     }
-
-    outputFile = fopen(output, "w");
 }
 
 
 /**
  * @brief
- *      Checks if the search text is appropriate for the prefix/suffix find and replace function 
- *      to be performed.
+ *      Checks if input and output indicate the same file, even through different paths.
  * 
- * @note
- *      Prefix search: search text must end with a '*'
- * @note
- *      Suffix search: search text must start with a '*'
+ * @param input
+ *      String indicating the input file.
+ * 
+ * @param output
+ *      String indicating the output file.
  * 
  * @return
- *      WILDCARD_INVALID if search text is invalid, otherwise 0;
-*/
-int checkSearchTextForW(){
-    //search_text like *apple* or apple are not allowed when a w flag is presented
-    bool doubleAsteriskError = (search_text[0] == '*' && search_text[searchLen - 1] == '*'),
-            noAsteriskError = (search_text[0] != '*' && search_text[searchLen - 1] != '*');
+ *      True if both paths lead to the same file.
+ */
+bool sameFile(char *input, char *output){
+    struct stat inputStat, outputStat;
 
-    if(doubleAsteriskError || noAsteriskError) return WILDCARD_INVALID;
-    return 0;
+    if(stat(input, &inputStat) || stat(output, &outputStat)) return false;
+    return inputStat.st_dev == outputStat.st_dev && inputStat.st_ino == outputStat.st_ino;
 }
 
 
 /**
  * @brief 
- * Reads the inputFile line by line and performs the corresponding find/replace function
- * based on the input mode.
+ * Performs the find/replace function on the inputFile and prints the results in the outputFile.
+ * 
+ * @note
+ *      Regular files are memory-mapped and scanned in place (see mappedFindReplace()). Pipes and other
+ *      files that can't be mapped are read through the FILE* path (see streamFindReplace()).
  * 
- * @param mode 
- *      Integer indicating which search/replace function should be performed.
+ * @param pattern
+ *      Compiled pattern of the search/replace function.
  * 
- * @param start_end_lines 
- *      Array containing the starting/ending line numbers which indicate the range of the
- *      search/replace function.
+ * @param threads
+ *      Number of threads a memory-mapped input file is split between (j flag).
+ * 
+ * @param inputPath
+ *      Pointer that is set to the name of the input path that was used ("mmap", "stream", etc.).
+ * 
+ * @param bytesRead
+ *      Pointer that is set to the number of bytes read from the inputFile.
+ * 
+ * @return
+ *      OUTPUT_WRITE_FAILED if the output couldn't be written completely (e.g. the disk is full), INPUT_READ_FAILED
+ *      if the input couldn't be read to its end, otherwise 0.
  */
-void findReplace(int mode, int *start_end_lines){
-    char curr_line[MAX_LINE + 1];
-    int lineNum = 1;
-    while(fgets(curr_line, MAX_LINE, inputFile)){
-        if(start_end_lines[0] <= lineNum && start_end_lines[1] >= lineNum){
-            if(mode == 0) 
-                replace(curr_line);
-            else if(mode == 1){
-                search_text[searchLen - 1] = '\0';
-                prefixReplace(curr_line, search_text);
+int findReplace(const fr_pattern *pattern, int threads, const char **inputPath, size_t *bytesRead){
+    struct stat inputStat;
+    int inputFd = fileno(inputFile);
+    bool written;
+
+    //A compressed file is never patched, since its bytes are not the texts being replaced.
+    bool compressed = inputCodec != NO_CODEC || outputCodec != NO_CODEC;
+    if(inPlacePath && !compressed && pattern->plan.sameLength && patchFindReplace(pattern)){
+        *inputPath = "in-place patch";
+        *bytesRead = fstat(inputFd, &inputStat) ? 0 : inputStat.st_size;
+        return 0;
+    }
+
+    if(!fstat(inputFd, &inputStat) && S_ISREG(inputStat.st_mode) && inputStat.st_size > 0){
+        off_t offset = lseek(inputFd, 0, SEEK_CUR);
+        size_t fileSize = inputStat.st_size;
+        char *mapping = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, inputFd, 0);
+
+        if(mapping != MAP_FAILED && offset >= 0 && (size_t)offset <= fileSize){
+            const int *start_end_lines = pattern->start_end_lines;
+            bool lineRange = start_end_lines[0] > 1 || start_end_lines[1] < INT_MAX;
+            size_t range[2];
+            madvise(mapping, fileSize, MADV_SEQUENTIAL);
+            *inputPath = threads > 1 ? "parallel mmap" : "mmap";
+
+            //With the l flag, only the lines of its range are scanned, found through the line index (x flag) or by
+            //counting the newlines before them.
+            if(indexedInput && !offset && indexLineRange(indexedInput, &inputStat, mapping, fileSize, start_end_lines, range)){
+                *inputPath = "indexed mmap";
+                written = rangeFindReplace(pattern, inputFd, mapping, fileSize, offset, range);
             }
+            else if(lineRange && threads <= 1){
+                scanLineRange(mapping + offset, fileSize - offset, start_end_lines, range);
+                range[0] += offset;
+                range[1] += offset;
+                *inputPath = "ranged mmap";
+                written = rangeFindReplace(pattern, inputFd, mapping, fileSize, offset, range);
+            }
+            else if(threads > 1)
+                written = parallelFindReplace(pattern, mapping + offset, fileSize - offset, threads);
             else
-                suffixReplace(curr_line, search_text + 1);
+                written = mappedFindReplace(pattern, mapping + offset, fileSize - offset);
+            munmap(mapping, fileSize);
+            *bytesRead = fileSize - offset;
+            return written ? 0 : OUTPUT_WRITE_FAILED;
         }
-        else 
-            fputs(curr_line, outputFile);
-        lineNum++;
+        if(mapping != MAP_FAILED) munmap(mapping, fileSize);
     }
+
+    *inputPath = "stream";
+    return streamFindReplace(pattern, bytesRead);
 }
 
 
 /**
  * @brief 
- * Performs the normal find/replace function, where all existence of search_text would be replace 
- * by replace_text.
+ * Performs the corresponding find/replace function on every line of a memory-mapped input file.
  * 
- * @param curr_line
- *      Line being read by the program.
+ * @note
+ *      The output is gathered with writeText() as iovecs that point into the mapping, so texts that are not
+ *      replaced are never copied before they reach writev. An equal-length search text instead gets a copy of
+ *      the mapping with its matches overwritten, written in big blocks through the writeBuffer (see patchedCopy()).
+ * 
+ * @param pattern
+ *      Compiled pattern of the search/replace function.
+ * 
+ * @param texts
+ *      Beginning of the mapped input file.
+ * 
+ * @param textsLen
+ *      Number of characters in the mapped input file.
+ * 
+ * @return
+ *      False if the output couldn't be written completely.
  */
-void replace(char *curr_line){
-    //If search_text == replace_text, print the original line in the outputFile.
-    if(!strcmp(search_text, replace_text)){
-        fputs(curr_line, outputFile);
-        return;
-    }
+bool mappedFindReplace(const fr_pattern *pattern, const char *texts, size_t textsLen){
+    fr_context context;
+    bool patching = pattern->plan.bytePatch;
 
-    char *word_found = strstr(curr_line, search_text); //Find the first occurrence of search_text.
-    //Loop until all search_line are replaced.
-    while(word_found){
-        int indexOfWord = (word_found - curr_line);
-        size_t lineLen = strlen(curr_line);
-        
-        /*
-        Print all texts before search_text + replace_text.
-        The index of search_text represents the number of characters that are before search_text.
-        */
-        fprintf(outputFile, "%.*s%s", indexOfWord, curr_line, replace_text);
+    if(patching && !writeBuffer && !(writeBuffer = allocWriteBuffer())) return false;
 
-        //when search_text is the last word in curr_line, stop the function.
-        if(*(word_found + searchLen) == '\0') return;
-        
-        getRemainingTexts(curr_line, word_found + searchLen, lineLen + 1);
-        word_found = strstr(curr_line, search_text);
-    }
-    fputs(curr_line, outputFile); //Prints all the leftover texts.
-}
+    initContext(&context, pattern, patching ? BUFFER_OUTPUT : GATHER_OUTPUT);
+    context.output.fd = fileno(outputFile);
+    context.output.buffer = writeBuffer;
+    if(fflush(outputFile)) return false;
 
+    if(patching) patchedCopy(&context, texts, textsLen);
+    else replaceLines(&context, texts, textsLen, true);
 
-/**
- * @brief
- * Performs the prefix find/replace function, where all words with the input prefix would be
- * replace by replace_text.
- * 
- * @param curr_line
- *      Line being read by the program.
- * 
- * @param prefix
- *      Prefix of a word.
- */
-void prefixReplace(char *curr_line, char *prefix){
-    char *prefix_found = strstr(curr_line, prefix);
-    while(prefix_found){
-        int indexOfWord = prefix_found - curr_line, endOfWordIndex = updateEndIndex(curr_line, lineLen, indexOfWord + searchLen - 1);
-        size_t lineLen = strlen(curr_line);
-
-
-        //Check if the prefix found is a true prefix, meaning it must be at the beginning of a word.
-        if(indexOfWord == 0 || !isalnum(curr_line[indexOfWord - 1]))
-            fprintf(outputFile, "%.*s%s", indexOfWord, curr_line, replace_text);
-        else
-            fprintf(outputFile, "%.*s", endOfWordIndex, curr_line);
-        
-        if(*(curr_line + endOfWordIndex) == '\0') return;
-        
-        getRemainingTexts(curr_line, curr_line + endOfWordIndex, lineLen + 1);
-        prefix_found = strstr(curr_line, prefix);
-    }
-    fputs(curr_line, outputFile);
+    bool written = flushOutput(&context.output);
+    releaseContext(&context);
+    recordStats(&context.stats);
+    return written;
 }
 
 
 /**
  * @brief
- * Performs the suffix find/replace function, where all words with the input suffix would be replace
- * by replace_text.
+ * Performs the corresponding find/replace function on the lines of the l flag of a memory-mapped input file,
+ * found with indexLineRange() or scanLineRange().
+ * 
+ * @note
+ *      The texts before and after the lines are copied from the input file to the outputFile by the kernel
+ *      (see copyInputRange()), without being read.
+ * 
+ * @param pattern
+ *      Compiled pattern of the search/replace function.
+ * 
+ * @param inputFd
+ *      File descriptor of the input file.
+ * 
+ * @param texts
+ *      Beginning of the mapped input file.
  * 
- * @param curr_line
- *      Line being read by the program.
+ * @param textsLen
+ *      Number of characters in the mapped input file.
  * 
- * @param suffix 
- *      Suffix of a word.
+ * @param offset
+ *      Offset of the first character of the input (past the texts already read from the inputFile).
+ * 
+ * @param range
+ *      Offset of the first character of the starting line and offset right after the ending line.
+ * 
+ * @return
+ *      False if the output couldn't be written completely.
  */
-void suffixReplace(char *curr_line, char *suffix){
-    char *suffix_found = strstr(curr_line, suffix);
-    while(suffix_found){
-        int indexOfWord = suffix_found - curr_line, endOfWordIndex = updateEndIndex(curr_line, lineLen, indexOfWord + searchLen - 1);
-        size_t lineLen = strlen(curr_line);
-        
-        
-        //Check if the suffix found is a true suffix, meaning it must be at the end of the word.
-        if(!strncmp(suffix, curr_line + (endOfWordIndex - (searchLen - 1)), searchLen - 1)){
-            int startOfWordIndex = updateStartIndex(curr_line, indexOfWord - 1);
-            fprintf(outputFile, "%.*s%s", startOfWordIndex + 1, curr_line, replace_text);
-        }
-        else fprintf(outputFile, "%.*s", endOfWordIndex, curr_line);
+bool rangeFindReplace(const fr_pattern *pattern, int inputFd, const char *texts, size_t textsLen, size_t offset,
+    const size_t *range){
+    fr_context context;
+    int outputFd = fileno(outputFile);
+
+    initContext(&context, pattern, GATHER_OUTPUT);
+    context.output.fd = outputFd;
+    context.lineNum = pattern->start_end_lines[0] > 1 ? pattern->start_end_lines[0] : 1;
+    COUNT_STAT(&context.stats, bytesWritten, (range[0] - offset) + (textsLen - range[1]));
+
+    //The lines before the range count as scanned, as on the other paths, although they are never read. Only an input
+    //that ends before the range has fewer of them, which are counted then.
+    long long linesBefore = context.lineNum - 1, missing = 0;
+    if(range[0] == textsLen){
+        missing = linesBefore;
+        skipNewlines(texts + offset, textsLen - offset, &missing);
+    }
+    COUNT_STAT(&context.stats, linesScanned, linesBefore - missing);
 
-        if(*(curr_line + endOfWordIndex) == '\0') return;
+    bool written = !fflush(outputFile);
+    TIME_STAT(&context.stats, outputSeconds, written = written && copyInputRange(inputFd, texts, offset, range[0] - offset, outputFd));
 
-        getRemainingTexts(curr_line, curr_line + endOfWordIndex, lineLen + 1);
-        suffix_found = strstr(curr_line, suffix);
+    if(written){
+        replaceLines(&context, texts + range[0], range[1] - range[0], true);
+        written = flushOutput(&context.output);
+        TIME_STAT(&context.stats, outputSeconds, written = written && copyInputRange(inputFd, texts, range[1], textsLen - range[1], outputFd));
     }
-    fputs(curr_line, outputFile);
+    releaseContext(&context);
+    recordStats(&context.stats);
+    return written;
 }
 
 
 /**
- * @brief 
- *      Obtains the index that indicates the ending of a word.
- *      For example, the ending index for "apple." is 5.
+ * @brief
+ *      Copies a part of a memory-mapped input file to an output file descriptor, at its current offset.
+ * 
+ * @note
+ *      copy_file_range() lets the file system copy (or share) the bytes without them ever reaching the
+ *      program. Where it isn't supported (e.g. across file systems or to a pipe), sendfile() is tried, and
+ *      the rest is written from the mapping.
+ * 
+ * @param inputFd
+ *      File descriptor of the input file.
  * 
- * @param curr_line
- *      Line being read by the program.
+ * @param texts
+ *      Beginning of the mapped input file.
  * 
- * @param lineLen
- *      Length or number of characters in the current line.
+ * @param offset
+ *      Offset of the first character to be copied.
  * 
- * @param endIndex
- *      Initial ending index.
+ * @param len
+ *      Number of characters to be copied.
+ * 
+ * @param outputFd
+ *      File descriptor of the output.
  * 
  * @return
- *      Updated ending index.
+ *      False if the texts couldn't be written completely.
  */
-int updateEndIndex(char *curr_line, int lineLen, int endIndex){
-    while(endIndex < lineLen && isalnum(curr_line[endIndex])) endIndex++;
-    return endIndex;
+bool copyInputRange(int inputFd, const char *texts, size_t offset, size_t len, int outputFd){
+    loff_t copyOffset = offset;
+    ssize_t copied;
+
+    while(len && (copied = copy_file_range(inputFd, &copyOffset, outputFd, NULL, len, 0)) > 0) len -= copied;
+
+    off_t sendOffset = copyOffset;
+    while(len && (copied = sendfile(outputFd, inputFd, &sendOffset, len)) > 0) len -= copied;
+
+    return !len || writeAll(outputFd, texts + sendOffset, len);
 }
 
 
 /**
  * @brief 
- *      Obtains the index that indicates the beginning of a word.
- *      For example, starting index for ". Apple" is 1.
+ * Reads the inputFile in blocks and performs the corresponding find/replace function on every line
+ * (see streamReplace()).
  * 
- * @param curr_line 
- *      Line being read by the program.
+ * @note
+ *      The output is copied into a page-aligned writeBuffer and written to the outputFile in big write()
+ *      calls, bypassing stdio. Both buffers are kept for the next input file of a batch, and freed by
+ *      releaseStreamBuffer().
+ * 
+ * @param pattern
+ *      Compiled pattern of the search/replace function.
  * 
- * @param startIndex
- *      Initial staring index.
+ * @param bytesRead
+ *      Pointer that is set to the number of bytes read from the inputFile.
  * 
  * @return
- *      Updated starting index.
+ *      INPUT_READ_FAILED if the inputFile couldn't be read to its end (or its buffer couldn't grow),
+ *      OUTPUT_WRITE_FAILED if the output couldn't be written completely, otherwise 0.
  */
-int updateStartIndex(char *curr_line, int startIndex){
-    while(startIndex >= 0 && isalnum(curr_line[startIndex])) startIndex--;
-    return startIndex;
+int streamFindReplace(const fr_pattern *pattern, size_t *bytesRead){
+    fr_context context;
+
+    *bytesRead = 0;
+    if(!writeBuffer && !(writeBuffer = allocWriteBuffer())) return OUTPUT_WRITE_FAILED;
+
+    initContext(&context, pattern, BUFFER_OUTPUT);
+    context.output.fd = fileno(outputFile);
+    context.output.buffer = writeBuffer;
+    if(fflush(outputFile)) return OUTPUT_WRITE_FAILED;
+
+    int error = streamReplace(&context, inputFile, &streamBuffer, &streamCapacity, bytesRead) ? INPUT_READ_FAILED : 0;
+
+    if(!flushOutput(&context.output) && !error) error = OUTPUT_WRITE_FAILED;
+    releaseContext(&context);
+    recordStats(&context.stats);
+    return error;
 }
 
 
 /**
- * @brief
- * Updates curr_line with all the characters after search_text.
- * 
- * @param curr_line 
- *      Line being read by the program.
- * 
- * @param startOfRemain
- *      Starting index of the remaining texts.
- * 
- * @param lineLen
- *      Length or number of characters in the current line.
- *      
+ * @brief 
+ *      Frees the buffers of streamFindReplace().
  */
-void getRemainingTexts(char *curr_line, char *startOfRemain, int lineLen){
-    char remain[lineLen];
-    strcpy(remain, startOfRemain);
-    strcpy(curr_line, remain);
+void releaseStreamBuffer(){
+    free(streamBuffer);
+    free(writeBuffer);
+    streamBuffer = writeBuffer = NULL;
+    streamCapacity = 0;
 }
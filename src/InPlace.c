@@ -0,0 +1,182 @@
+/**
+ * @file InPlace.c
+ *
+ * @brief
+ *      Edits a file in place when the same file is entered as both the input and output files.
+ *
+ * @note
+ *      The output is written to a temporary file next to the original, which is renamed over the original
+ *      once it is complete, so a run that stops halfway never leaves a truncated file behind. When every
+ *      replacement has the same length as its search text, the bytes are patched straight in a writable
+ *      mapping of the file instead, and nothing else is copied.
+ */
+#include "FindReplace.h"
+
+//Path of the file being edited in place, or NULL when the output is a different file
+_Thread_local char *inPlacePath = NULL;
+
+//Path of the output with all symbolic links resolved, so the rename replaces the file rather than the link
+static _Thread_local char resolvedPath[PATH_MAX];
+
+//Temporary file that receives the output until it is renamed over inPlacePath
+static _Thread_local char tempPath[PATH_MAX];
+
+//Indicates whether the file was patched through a writable mapping, in which case tempPath is unused
+static _Thread_local bool patched = false;
+
+
+/**
+ * @brief
+ *      Creates the temporary file that receives the output of an in-place edit.
+ *
+ * @note
+ *      The temporary file is created in the same directory as the file that path leads to, so rename() never
+ *      crosses file systems, and it gets the permissions of that file. Its owner and group are copied as well
+ *      when the process may do so (e.g. an edit by root), otherwise they stay those of the process.
+ *
+ * @param path
+ *      String indicating the file being edited in place.
+ *
+ * @return
+ *      Temporary file opened for writing, or NULL if path is unwritable or the file couldn't be created.
+ */
+FILE *openSiblingTemp(char *path){
+    struct stat pathStat;
+
+    if(stat(path, &pathStat) || access(path, W_OK) || !realpath(path, resolvedPath)) return NULL;
+
+    const char *slash = strrchr(resolvedPath, '/');
+    int dirLen = slash - resolvedPath + 1;
+    if(snprintf(tempPath, sizeof(tempPath), "%.*s.%s.XXXXXX", dirLen, resolvedPath, slash + 1) >= (int)sizeof(tempPath))
+        return NULL;
+
+    int tempFd = mkstemp(tempPath);
+    if(tempFd < 0) return NULL;
+    if(fchown(tempFd, pathStat.st_uid, pathStat.st_gid)){}
+    fchmod(tempFd, pathStat.st_mode & 07777);
+
+    FILE *tempFile = fdopen(tempFd, "w");
+    if(!tempFile){
+        close(tempFd);
+        unlink(tempPath);
+        return NULL;
+    }
+
+    inPlacePath = resolvedPath;
+    patched = false;
+    return tempFile;
+}
+
+
+/**
+ * @brief
+ * Performs the corresponding find/replace function by patching the file of inPlacePath in place.
+ *
+ * @note
+ *      Only valid when every replacement has the same length as its search text, so every byte of the
+ *      output lands at the offset it was read from. writeText() then skips the texts that are not replaced,
+ *      and only the pages holding a replacement are ever dirtied.
+ *
+ * @param pattern
+ *      Compiled pattern of the search/replace function.
+ *
+ * @return
+ *      False if the file couldn't be mapped for writing, in which case nothing is patched.
+ */
+bool patchFindReplace(const fr_pattern *pattern){
+    struct stat fileStat;
+    int fileFd = open(inPlacePath, O_RDWR);
+
+    if(fileFd < 0) return false;
+    if(fstat(fileFd, &fileStat) || !S_ISREG(fileStat.st_mode) || fileStat.st_size <= 0){
+        close(fileFd);
+        return false;
+    }
+
+    size_t fileSize = fileStat.st_size;
+    char *mapping = mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileFd, 0);
+    close(fileFd);
+    if(mapping == MAP_FAILED) return false;
+
+    fr_context context;
+    initContext(&context, pattern, PATCH_OUTPUT);
+    context.output.patchBase = mapping;
+    madvise(mapping, fileSize, MADV_SEQUENTIAL);
+
+    //An equal-length search text is overwritten at its matches, without splitting the file into lines.
+    if(pattern->plan.bytePatch) patchBlock(&context, mapping, fileSize, true);
+    else replaceLines(&context, mapping, fileSize, true);
+    releaseContext(&context);
+    recordStats(&context.stats);
+
+    munmap(mapping, fileSize);
+    patched = true;
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Syncs the directory of a file, so a rename() in it survives a crash. Failures are ignored, since the
+ *      rename is already done.
+ *
+ * @param path
+ *      String indicating the file, with its directory.
+ */
+static void syncParentDir(const char *path){
+    char dirPath[PATH_MAX];
+    const char *slash = strrchr(path, '/');
+
+    snprintf(dirPath, sizeof(dirPath), "%.*s", slash ? (int)(slash - path) + 1 : 1, slash ? path : ".");
+    int dirFd = open(dirPath, O_RDONLY | O_DIRECTORY);
+    if(dirFd < 0) return;
+    fsync(dirFd);
+    close(dirFd);
+}
+
+
+/**
+ * @brief
+ *      Completes an in-place edit by closing the outputFile and renaming the temporary file over inPlacePath.
+ *
+ * @note
+ *      The temporary file is synced before the rename, and its directory after it, so after a crash the original
+ *      holds either the old or the new texts. When the file was patched, the output failed, or the inputFile
+ *      wasn't read to its end, the temporary file is removed instead. The inputFile must still be open.
+ *
+ * @param error
+ *      Error code of the find/replace function, or 0 if the output was written completely.
+ *
+ * @return
+ *      OUTPUT_WRITE_FAILED if the output couldn't be written completely, INPUT_READ_FAILED if the input couldn't
+ *      be read to its end, OUTPUT_FILE_UNWRITABLE if it couldn't replace the original (in all cases the original
+ *      is left untouched), otherwise 0.
+ */
+int finishInPlace(int error){
+    //A read error of the inputFile leaves the output incomplete, even if the find/replace function missed it.
+    if(!error && !patched && ferror(inputFile)) error = INPUT_READ_FAILED;
+    if(!error && !patched && (fflush(outputFile) || fsync(fileno(outputFile)))) error = OUTPUT_WRITE_FAILED;
+    if(fclose(outputFile) && !error && !patched) error = OUTPUT_WRITE_FAILED;
+
+    if(!error && !patched && !rename(tempPath, inPlacePath)){
+        syncParentDir(inPlacePath);
+        return 0;
+    }
+    if(!error && !patched) error = OUTPUT_FILE_UNWRITABLE;
+
+    unlink(tempPath);
+    return error;
+}
+
+
+/**
+ * @brief
+ *      Drops an in-place edit that won't be performed, leaving the original untouched.
+ */
+void discardInPlace(){
+    if(!inPlacePath || !outputFile) return;
+
+    fclose(outputFile);
+    outputFile = NULL;
+    unlink(tempPath);
+}
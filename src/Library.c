@@ -0,0 +1,461 @@
+/**
+ * @file Library.c
+ *
+ * @brief
+ *      Public functions of libfindreplace: compiles the search spec of the s/r/f/w/l/E/i/u flags into a pattern,
+ *      and applies it to buffers and streams through contexts (see libfindreplace.h).
+ *
+ * @note
+ *      A compiled pattern is never written again, and everything that changes while an input is processed
+ *      lives in its context, so the library holds no state of its own.
+ */
+#include "Engine.h"
+
+
+/**
+ * @brief
+ *      Checks if a search text is appropriate for the prefix/suffix/glob find and replace functions (w flag).
+ *
+ * @note
+ *      Prefix search: search text must end with a '*'
+ * @note
+ *      Suffix search: search text must start with a '*'
+ * @note
+ *      Glob search: any other search text with a '*' or a '?' (see compileWordGlob())
+ *
+ * @param search
+ *      Search text, including its '*' and '?'.
+ *
+ * @param globs
+ *      Boolean value indicating whether a glob is allowed. The s flag pair of a rules file must be a prefix/suffix,
+ *      like its rules.
+ *
+ * @return
+ *      True if the search text has a wildcard, or is a prefix or a suffix but not both when globs are not allowed.
+ */
+static bool validWildcard(const char *search, bool globs){
+    size_t searchLen = strlen(search);
+
+    //Search texts like apple are not allowed when a w flag is presented, nor *apple* along with a rules file
+    if(globs) return strpbrk(search, "*?");
+    return (search[0] == '*') != (search[searchLen - 1] == '*');
+}
+
+
+/**
+ * @brief
+ *      Compiles the search/replace pair of the s/r flags.
+ *
+ * @param pattern
+ *      Pattern receiving the pair.
+ *
+ * @param search
+ *      Search text, including the '*' of a prefix/suffix.
+ *
+ * @param replace
+ *      Replacement text.
+ *
+ * @return
+ *      Error code if an error is encountered, otherwise FR_OK.
+ */
+static int compileSearch(fr_pattern *pattern, const char *search, const char *replace){
+    size_t searchLen = strlen(search);
+
+    if(search[searchLen - 1] == '*') pattern->mode = 1;
+    else if(search[0] == '*') pattern->mode = 2;
+
+    //The '*' of the prefix/suffix modes is not part of the texts being searched.
+    if(pattern->mode) searchLen--;
+    if(!searchLen) return FR_SEARCH_INVALID;
+
+    pattern->search = strndup(search + (pattern->mode == 2), searchLen);
+    pattern->replace = strdup(replace);
+    if(!pattern->search || !pattern->replace) return FR_OUT_OF_MEMORY;
+
+    pattern->searchLen = searchLen;
+    pattern->replaceLen = strlen(replace);
+    return FR_OK;
+}
+
+
+/**
+ * @brief
+ *      Compiles the glob of the s flag (w flag) and its replacement text.
+ *
+ * @param pattern
+ *      Pattern receiving the glob, whose words and fold are already set.
+ *
+ * @param search
+ *      Search text of the glob.
+ *
+ * @param replace
+ *      Replacement text.
+ *
+ * @return
+ *      Error code if an error is encountered, otherwise FR_OK.
+ */
+static int compileGlobSearch(fr_pattern *pattern, const char *search, const char *replace){
+    int error;
+
+    pattern->mode = 5;
+    error = compileWordGlob(&pattern->glob, search, &pattern->plan.words, pattern->plan.fold, &pattern->search, &pattern->searchLen);
+    if(error) return error;
+
+    pattern->replace = strdup(replace);
+    if(!pattern->replace) return FR_OUT_OF_MEMORY;
+    pattern->replaceLen = strlen(replace);
+    return FR_OK;
+}
+
+
+/**
+ * @brief
+ *      Compiles the regex of the s flag (E flag) and its replacement text.
+ *
+ * @note
+ *      The literal prefix of the regex becomes the search text of the pattern, so its search kernel is chosen
+ *      like that of any other search text.
+ *
+ * @param pattern
+ *      Pattern receiving the regex.
+ *
+ * @param options
+ *      Options of the pattern.
+ *
+ * @return
+ *      Error code if an error is encountered, otherwise FR_OK.
+ */
+static int compileRegexSearch(fr_pattern *pattern, const fr_options *options){
+    pattern->mode = 4;
+    if(options->wildcard || options->rulesPath) return FR_REGEX_INVALID;
+    return compileRegex(&pattern->regex, options->search, options->replace, options->ignoreCase, &pattern->search,
+        &pattern->searchLen);
+}
+
+
+/**
+ * @brief
+ *      Compiles the rules of a rules file into their automaton.
+ *
+ * @note
+ *      When a search/replace pair is entered as well, it becomes the first rule.
+ *
+ * @param pattern
+ *      Pattern receiving the rules.
+ *
+ * @param options
+ *      Options of the pattern.
+ *
+ * @return
+ *      Error code if an error is encountered, otherwise FR_OK.
+ */
+static int compileRules(fr_pattern *pattern, const fr_options *options){
+    int error;
+
+    pattern->mode = 3;
+    pattern->rules.ignoreCase = options->ignoreCase;
+    if(options->search && !addRule(&pattern->rules, options->search, options->replace)) return FR_RULES_FILE_INVALID;
+
+    if((error = loadRules(&pattern->rules, options->rulesPath, options->wildcard))) return error;
+    if(!buildAutomaton(&pattern->rules)) return FR_RULES_FILE_INVALID;
+    return FR_OK;
+}
+
+
+/**
+ * @brief
+ *      Derives the search plan of a pattern, once its search texts are compiled.
+ *
+ * @param pattern
+ *      Pattern receiving the plan.
+ */
+static void compilePlan(fr_pattern *pattern){
+    SearchPlan *plan = &pattern->plan;
+    const RuleSet *rules = &pattern->rules;
+    LineKernel kernels[] = {replace, prefixReplace, suffixReplace, multiReplace, regexReplace, globReplace};
+
+    plan->kernel = kernels[pattern->mode];
+    if(pattern->mode == 0 && !plan->fold && !strcmp(pattern->search, pattern->replace)) plan->kernel = copyLine;
+
+    //Prefixes/suffixes made only of word characters are found along with their word boundaries (see AffixScanner).
+    bool wordAffix = (pattern->mode == 1 || pattern->mode == 2) && pattern->searchLen <= AFFIX_SCAN_MAX;
+    for(size_t i = 0; wordAffix && i < pattern->searchLen; i++){
+        wordAffix = plan->words.bytes[(unsigned char)pattern->search[i]];
+    }
+    if(wordAffix) plan->kernel = pattern->mode == 1 ? prefixWordsReplace : suffixWordsReplace;
+
+    //A folded search text is matched by kernels that fold the texts in their registers (see foldedPatternKernel()).
+    if(plan->fold) foldText(pattern->search, pattern->searchLen);
+    plan->search = plan->fold ? foldedPatternKernel(pattern->searchLen) : patternKernel(pattern->searchLen);
+    if(pattern->searchLen >= TWO_WAY_MIN) buildPatternTable(pattern->search, pattern->searchLen, plan->fold, &plan->table);
+
+    //Prefix/suffix rules replace whole words, whose lengths vary.
+    plan->sameLength = pattern->mode == 0 ? pattern->searchLen == pattern->replaceLen : pattern->mode == 3;
+    for(size_t r = 0; r < rules->ruleCount; r++){
+        if(rules->rules[r].mode || rules->rules[r].searchLen != rules->rules[r].replaceLen) plan->sameLength = false;
+    }
+
+    //A match never crosses a line, so only a '\n' at the very end of the search text keeps the lines out of it.
+    bool allLines = pattern->start_end_lines[0] <= 1 && pattern->start_end_lines[1] == INT_MAX;
+    plan->bytePatch = pattern->mode == 0 && plan->sameLength && plan->kernel != copyLine && allLines &&
+        !memchr(pattern->search, '\n', pattern->searchLen - 1);
+}
+
+
+/**
+ * @brief
+ *      Compiles a search spec into a pattern that may be shared by any number of contexts and threads.
+ *
+ * @param options
+ *      Options of the pattern (see fr_options).
+ *
+ * @param compiled
+ *      Pointer that is set to the pattern, or to NULL if an error is encountered.
+ *
+ * @return
+ *      FR_SEARCH_INVALID, FR_REPLACE_INVALID, FR_LINES_INVALID, FR_RULES_FILE_INVALID, FR_WILDCARD_INVALID,
+ *      FR_REGEX_INVALID or FR_OUT_OF_MEMORY if the pattern couldn't be compiled, otherwise FR_OK.
+ */
+int fr_compile(const fr_options *options, fr_pattern **compiled){
+    fr_pattern *pattern = calloc(1, sizeof(fr_pattern));
+    int error = FR_OK;
+
+    *compiled = NULL;
+    if(!pattern) return FR_OUT_OF_MEMORY;
+
+    pattern->start_end_lines[0] = options->lineRange ? options->startLine : 1;
+    pattern->start_end_lines[1] = options->lineRange ? options->endLine : INT_MAX;
+    pattern->plan.fold = options->ignoreCase;
+    initWordSet(&pattern->plan.words, options->utf8);
+    buildWordClasses(pattern->plan.words.bytes, &pattern->plan.wordClasses);
+
+    if(options->search ? !options->search[0] : !options->rulesPath) error = FR_SEARCH_INVALID;
+    else if(options->search && !options->replace) error = FR_REPLACE_INVALID;
+    else if(pattern->start_end_lines[0] > pattern->start_end_lines[1]) error = FR_LINES_INVALID;
+    else if(options->regex) error = compileRegexSearch(pattern, options);
+    else if(options->search && options->wildcard && !validWildcard(options->search, !options->rulesPath)) error = FR_WILDCARD_INVALID;
+    else if(options->rulesPath) error = compileRules(pattern, options);
+    else if(options->wildcard && isWordGlob(options->search)) error = compileGlobSearch(pattern, options->search, options->replace);
+    else error = compileSearch(pattern, options->search, options->replace);
+
+    if(error){
+        fr_free(pattern);
+        return error;
+    }
+
+    //The search kernel is chosen before any context may use the pattern.
+    compilePlan(pattern);
+    *compiled = pattern;
+    return FR_OK;
+}
+
+
+/**
+ * @brief
+ *      Frees a pattern. It must not be used by any context anymore.
+ *
+ * @param pattern
+ *      Pattern to be freed, or NULL.
+ */
+void fr_free(fr_pattern *pattern){
+    if(!pattern) return;
+
+    free(pattern->search);
+    free(pattern->replace);
+    freeRules(&pattern->rules);
+    freeRegex(&pattern->regex);
+    free(pattern);
+}
+
+
+/**
+ * @brief
+ *      Creates a context that feeds an input to a pattern and hands the output to a callback.
+ *
+ * @param pattern
+ *      Compiled pattern, which must outlive the context.
+ *
+ * @param write
+ *      Function receiving the output.
+ *
+ * @param user
+ *      Pointer passed to write.
+ *
+ * @return
+ *      New context, or NULL if it couldn't be allocated.
+ */
+fr_context *fr_context_new(const fr_pattern *pattern, fr_write_fn write, void *user){
+    fr_context *context = malloc(sizeof(fr_context));
+
+    if(!context || !write){
+        free(context);
+        return NULL;
+    }
+
+    initContext(context, pattern, CALLBACK_OUTPUT);
+    context->output.write = write;
+    context->output.user = user;
+    return context;
+}
+
+
+/**
+ * @brief
+ *      Frees a context. The output of an input that was never completed (see fr_apply_buffer()) is dropped.
+ *
+ * @param context
+ *      Context to be freed, or NULL.
+ */
+void fr_context_free(fr_context *context){
+    if(!context) return;
+
+    releaseContext(context);
+    free(context->carry);
+    free(context);
+}
+
+
+/**
+ * @brief
+ *      Obtains the counters of a context, which add up every input fed to it since it was created.
+ *
+ * @param context
+ *      Context of the inputs.
+ *
+ * @param stats
+ *      fr_stats receiving the counters, which all stay at 0 in a library built with -DNO_STATS.
+ */
+void fr_context_stats(const fr_context *context, fr_stats *stats){
+    *stats = context->stats;
+}
+
+
+/**
+ * @brief
+ *      Appends texts to the undecided texts carried by a context.
+ *
+ * @return
+ *      False if the carry couldn't be enlarged.
+ */
+static bool appendCarry(fr_context *context, const char *texts, size_t textsLen){
+    if(!textsLen) return true;
+
+    if(context->carryLen + textsLen > context->carryCapacity){
+        size_t capacity = context->carryCapacity ? context->carryCapacity : BLOCK_SIZE;
+        while(capacity < context->carryLen + textsLen) capacity *= 2;
+
+        char *larger = realloc(context->carry, capacity);
+        if(!larger) return false;
+        context->carry = larger;
+        context->carryCapacity = capacity;
+    }
+
+    memcpy(context->carry + context->carryLen, texts, textsLen);
+    context->carryLen += textsLen;
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Performs the find/replace function of the pattern on the next buffer of an input.
+ *
+ * @note
+ *      Buffers may split the input anywhere, even inside a match. The texts at the end of a buffer that can't
+ *      be decided yet are kept by the context and completed with the beginning of the next buffer, so the
+ *      output is the same as if the whole input were passed at once. All output of a buffer is handed to the
+ *      callback before the call returns.
+ *
+ * @param context
+ *      Context of the input.
+ *
+ * @param texts
+ *      Next buffer of the input. It doesn't need to be null-terminated.
+ *
+ * @param textsLen
+ *      Number of characters in texts.
+ *
+ * @param last
+ *      Boolean value indicating whether texts end the input. The context then starts over for a new input.
+ *
+ * @return
+ *      FR_WRITE_FAILED if the callback failed to write any output of the input so far, FR_OUT_OF_MEMORY if the
+ *      undecided texts couldn't be kept, otherwise FR_OK.
+ */
+int fr_apply_buffer(fr_context *context, const char *texts, size_t textsLen, bool last){
+    size_t pos = 0;
+
+    //The undecided texts of the previous buffer are completed with the rest of their line first.
+    if(context->carryLen){
+        const char *newline = textsLen ? memchr(texts, '\n', textsLen) : NULL;
+        pos = newline ? (size_t)(newline - texts) + 1 : textsLen;
+        if(!appendCarry(context, texts, pos)) return FR_OUT_OF_MEMORY;
+
+        size_t consumed = replaceLines(context, context->carry, context->carryLen, last && pos == textsLen);
+        flushOutput(&context->output);
+        context->carryLen -= consumed;
+        memmove(context->carry, context->carry + consumed, context->carryLen);
+    }
+
+    if(!context->carryLen){
+        size_t consumed = replaceLines(context, texts + pos, textsLen - pos, last);
+        flushOutput(&context->output);
+        if(!appendCarry(context, texts + pos + consumed, textsLen - pos - consumed)) return FR_OUT_OF_MEMORY;
+    }
+
+    int error = context->output.failed ? FR_WRITE_FAILED : FR_OK;
+    if(last){
+        context->lineNum = 1;
+        context->lineStart = true;
+        context->wordBefore = false;
+        context->wordState = WORD_NONE;
+        context->carryLen = 0;
+        context->output.failed = false;
+    }
+    return error;
+}
+
+
+/**
+ * @brief
+ *      Performs the find/replace function of the pattern on a whole stream.
+ *
+ * @param pattern
+ *      Compiled pattern.
+ *
+ * @param input
+ *      Stream to be read until its end.
+ *
+ * @param output
+ *      Stream receiving the output. Its pending texts are flushed first, and the output is then written to its
+ *      file descriptor without going through stdio, so it must be backed by one (not a memory stream).
+ *
+ * @param bytesRead
+ *      Pointer that is set to the number of bytes read from input, or NULL.
+ *
+ * @return
+ *      FR_READ_FAILED if the input couldn't be read to its end, FR_WRITE_FAILED if the output couldn't be written
+ *      completely, FR_OUT_OF_MEMORY if the buffers couldn't be allocated, otherwise FR_OK.
+ */
+int fr_apply_stream(const fr_pattern *pattern, FILE *input, FILE *output, size_t *bytesRead){
+    fr_context context;
+    char *buffer = NULL;
+    size_t capacity = 0, totalRead = 0;
+    int error = FR_OUT_OF_MEMORY;
+
+    initContext(&context, pattern, BUFFER_OUTPUT);
+    context.output.fd = fileno(output);
+    context.output.buffer = allocWriteBuffer();
+
+    if(context.output.buffer){
+        if(fflush(output)) context.output.failed = true;
+        error = streamReplace(&context, input, &buffer, &capacity, &totalRead);
+        if(!flushOutput(&context.output) && !error) error = FR_WRITE_FAILED;
+    }
+
+    if(bytesRead) *bytesRead = totalRead;
+    releaseContext(&context);
+    free(context.output.buffer);
+    free(buffer);
+    return error;
+}
@@ -0,0 +1,273 @@
+/**
+ * @file LineIndex.c
+ *
+ * @brief
+ *      Finds the lines of the l flag in a memory-mapped input file, either by scanning for the newlines before
+ *      them or through a line index kept beside the input file (x flag), which skips most of that scan.
+ *
+ * @note
+ *      The index is a file named after the input file with LINE_INDEX_SUFFIX appended. It holds the byte offset
+ *      of every LINE_INDEX_INTERVAL-th line, along with the size and modification time of the input file. It is
+ *      built the first time the input file is used with the l flag (or once the file has changed) and read by
+ *      the runs that follow. An index that can't be written is only used for the current run.
+ */
+#include "FindReplace.h"
+
+static const char lineIndexMagic[8] = "FRLINES1";
+
+
+/**
+ * @brief
+ *      Reads the line index of an input file, if it still describes the file.
+ *
+ * @param indexPath
+ *      String indicating the index file.
+ *
+ * @param inputStat
+ *      Status of the input file.
+ *
+ * @param index
+ *      LineIndex receiving the offsets, which are allocated on success.
+ *
+ * @return
+ *      False if the index is missing, unreadable or out of date.
+ */
+static bool loadLineIndex(const char *indexPath, const struct stat *inputStat, LineIndex *index){
+    LineIndexHeader *header = &index->header;
+    struct stat indexStat;
+    int indexFd = open(indexPath, O_RDONLY);
+
+    if(indexFd < 0) return false;
+
+    bool loaded = !fstat(indexFd, &indexStat) && read(indexFd, header, sizeof(*header)) == sizeof(*header)
+        && !memcmp(header->magic, lineIndexMagic, sizeof(lineIndexMagic)) && header->interval == LINE_INDEX_INTERVAL
+        && header->fileSize == (uint64_t)inputStat->st_size && header->mtimeSec == inputStat->st_mtim.tv_sec
+        && header->mtimeNsec == inputStat->st_mtim.tv_nsec && header->entryCount > 0
+        && (uint64_t)indexStat.st_size == sizeof(*header) + header->entryCount * sizeof(uint64_t);
+
+    size_t offsetsLen = loaded ? header->entryCount * sizeof(uint64_t) : 0;
+    if(loaded && !(index->offsets = malloc(offsetsLen))) loaded = false;
+    if(loaded && read(indexFd, index->offsets, offsetsLen) != (ssize_t)offsetsLen){
+        free(index->offsets);
+        loaded = false;
+    }
+
+    close(indexFd);
+    return loaded;
+}
+
+
+/**
+ * @brief
+ *      Builds the line index of a memory-mapped input file.
+ *
+ * @param texts
+ *      Beginning of the mapped input file.
+ *
+ * @param textsLen
+ *      Number of characters in the mapped input file.
+ *
+ * @param inputStat
+ *      Status of the input file.
+ *
+ * @param index
+ *      LineIndex receiving the offsets, which are allocated on success.
+ *
+ * @return
+ *      False if the offsets couldn't be allocated.
+ */
+static bool buildLineIndex(const char *texts, size_t textsLen, const struct stat *inputStat, LineIndex *index){
+    LineIndexHeader *header = &index->header;
+    size_t capacity = 1 + textsLen / (LINE_INDEX_INTERVAL * 64), pos = 0;
+
+    memcpy(header->magic, lineIndexMagic, sizeof(lineIndexMagic));
+    header->interval = LINE_INDEX_INTERVAL;
+    header->fileSize = inputStat->st_size;
+    header->mtimeSec = inputStat->st_mtim.tv_sec;
+    header->mtimeNsec = inputStat->st_mtim.tv_nsec;
+
+    if(!(index->offsets = malloc(capacity * sizeof(uint64_t)))) return false;
+    index->offsets[0] = 0;
+    header->entryCount = 1;
+
+    while(pos < textsLen){
+        long long lines = LINE_INDEX_INTERVAL;
+        pos += skipNewlines(texts + pos, textsLen - pos, &lines);
+        if(lines || pos == textsLen) break;
+
+        if(header->entryCount == capacity){
+            uint64_t *offsets = realloc(index->offsets, 2 * capacity * sizeof(uint64_t));
+            if(!offsets){
+                free(index->offsets);
+                return false;
+            }
+            index->offsets = offsets;
+            capacity *= 2;
+        }
+        index->offsets[header->entryCount++] = pos;
+    }
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Writes the line index of an input file.
+ *
+ * @note
+ *      The index is written to a temporary file that is renamed over indexPath once it is complete, so a
+ *      concurrent run never reads half an index. Nothing is written if the directory is unwritable.
+ *
+ * @param indexPath
+ *      String indicating the index file.
+ *
+ * @param index
+ *      LineIndex to be written.
+ */
+static void saveLineIndex(const char *indexPath, const LineIndex *index){
+    char tempPath[PATH_MAX];
+
+    if(snprintf(tempPath, sizeof(tempPath), "%s.XXXXXX", indexPath) >= (int)sizeof(tempPath)) return;
+
+    int tempFd = mkstemp(tempPath);
+    if(tempFd < 0) return;
+
+    bool written = writeAll(tempFd, (const char *)&index->header, sizeof(index->header))
+        && writeAll(tempFd, (const char *)index->offsets, index->header.entryCount * sizeof(uint64_t));
+    if(close(tempFd) || !written || rename(tempPath, indexPath)) unlink(tempPath);
+}
+
+
+/**
+ * @brief
+ *      Skips a number of lines of a memory-mapped input file, only looking for their newlines.
+ *
+ * @param texts
+ *      Beginning of the mapped input file.
+ *
+ * @param textsLen
+ *      Number of characters in the mapped input file.
+ *
+ * @param pos
+ *      Offset of the first character of the first line to be skipped.
+ *
+ * @param lines
+ *      Number of lines to be skipped.
+ *
+ * @return
+ *      Offset of the first character of the line that follows them, or textsLen if the input file ends first.
+ */
+static size_t skipLines(const char *texts, size_t textsLen, size_t pos, long long lines){
+    return pos + skipNewlines(texts + pos, textsLen - pos, &lines);
+}
+
+
+/**
+ * @brief
+ *      Finds the beginning of a line of a memory-mapped input file.
+ *
+ * @note
+ *      The scan starts at the closest indexed line before it, so at most LINE_INDEX_INTERVAL - 1 lines are
+ *      scanned (or the lines after the last indexed one) by skipLines().
+ *
+ * @param index
+ *      Line index of the input file.
+ *
+ * @param texts
+ *      Beginning of the mapped input file.
+ *
+ * @param textsLen
+ *      Number of characters in the mapped input file.
+ *
+ * @param line
+ *      Line number, counted from 1.
+ *
+ * @return
+ *      Offset of the first character of the line, or textsLen if the input file has fewer lines.
+ */
+static size_t lineOffset(const LineIndex *index, const char *texts, size_t textsLen, long long line){
+    if(line <= 1) return 0;
+
+    unsigned long long entry = (line - 1) / LINE_INDEX_INTERVAL;
+    if(entry >= index->header.entryCount) entry = index->header.entryCount - 1;
+
+    size_t pos = index->offsets[entry] < textsLen ? index->offsets[entry] : textsLen;
+    return skipLines(texts, textsLen, pos, line - (long long)(entry * LINE_INDEX_INTERVAL + 1));
+}
+
+
+/**
+ * @brief
+ *      Finds the lines of the l flag in a memory-mapped input file through its line index.
+ *
+ * @note
+ *      The index is read from the file beside the input file, or built (and saved there) if it is missing or
+ *      out of date.
+ *
+ * @param path
+ *      String indicating the input file.
+ *
+ * @param inputStat
+ *      Status of the input file.
+ *
+ * @param texts
+ *      Beginning of the mapped input file.
+ *
+ * @param textsLen
+ *      Number of characters in the mapped input file.
+ *
+ * @param start_end_lines
+ *      Starting and ending line numbers of the l flag.
+ *
+ * @param range
+ *      Array set to the offset of the first character of the starting line and the offset right after the
+ *      ending line.
+ *
+ * @return
+ *      False if the index couldn't be read or built.
+ */
+bool indexLineRange(const char *path, const struct stat *inputStat, const char *texts, size_t textsLen,
+    const int *start_end_lines, size_t *range){
+    char indexPath[PATH_MAX];
+    LineIndex index;
+
+    if(snprintf(indexPath, sizeof(indexPath), "%s%s", path, LINE_INDEX_SUFFIX) >= (int)sizeof(indexPath)) return false;
+
+    if(!loadLineIndex(indexPath, inputStat, &index)){
+        if(!buildLineIndex(texts, textsLen, inputStat, &index)) return false;
+        saveLineIndex(indexPath, &index);
+    }
+
+    range[0] = lineOffset(&index, texts, textsLen, start_end_lines[0]);
+    range[1] = lineOffset(&index, texts, textsLen, (long long)start_end_lines[1] + 1);
+    free(index.offsets);
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Finds the lines of the l flag in a memory-mapped input file without a line index.
+ *
+ * @note
+ *      Only the newlines up to the ending line are looked for, so the texts after it are never scanned.
+ *
+ * @param texts
+ *      Beginning of the mapped input.
+ *
+ * @param textsLen
+ *      Number of characters in the mapped input.
+ *
+ * @param start_end_lines
+ *      Starting and ending line numbers of the l flag.
+ *
+ * @param range
+ *      Array set to the offset of the first character of the starting line and the offset right after the
+ *      ending line.
+ */
+void scanLineRange(const char *texts, size_t textsLen, const int *start_end_lines, size_t *range){
+    long long startLine = start_end_lines[0] > 1 ? start_end_lines[0] : 1;
+
+    range[0] = skipLines(texts, textsLen, 0, startLine - 1);
+    range[1] = skipLines(texts, textsLen, range[0], (long long)start_end_lines[1] - startLine + 1);
+}
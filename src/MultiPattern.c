@@ -0,0 +1,301 @@
+/**
+ * @file MultiPattern.c
+ *
+ * @brief
+ *      Loads the search/replace rules of a rules file (f flag) and finds the leftmost-longest match of all
+ *      rules in a single scan with an Aho-Corasick automaton.
+ *
+ * @note
+ *      Rules file format: one rule per line, the search text and the replacement text separated by a tab.
+ *      Empty lines and lines starting with '#' are skipped. As with the s flag, a search text ending with '*'
+ *      is a prefix rule and one starting with '*' is a suffix rule.
+ */
+#include "Engine.h"
+
+
+/**
+ * @brief
+ *      Adds a search/replace pair to the rules.
+ *
+ * @param rules
+ *      RuleSet receiving the rule.
+ *
+ * @param search
+ *      Search text, including the '*' of a prefix/suffix rule. It is folded when the rules ignore case.
+ *
+ * @param replace
+ *      Replacement text.
+ *
+ * @return
+ *      False if the search text is empty (apart from the '*') or the rule couldn't be allocated.
+ */
+bool addRule(RuleSet *rules, const char *search, const char *replace){
+    size_t searchLen = strlen(search);
+    int mode = 0;
+
+    if(searchLen && search[searchLen - 1] == '*') mode = 1;
+    else if(searchLen && search[0] == '*') mode = 2;
+    if(mode) searchLen--;
+    if(!searchLen) return false;
+
+    if(rules->ruleCount == rules->ruleCapacity){
+        size_t capacity = rules->ruleCapacity ? rules->ruleCapacity * 2 : 64;
+        Rule *larger = realloc(rules->rules, capacity * sizeof(Rule));
+        if(!larger) return false;
+        rules->rules = larger;
+        rules->ruleCapacity = capacity;
+    }
+
+    Rule *rule = rules->rules + rules->ruleCount;
+    rule->search = strndup(search + (mode == 2), searchLen);
+    rule->replace = strdup(replace);
+    if(!rule->search || !rule->replace){
+        free(rule->search);
+        free(rule->replace);
+        return false;
+    }
+
+    rule->searchLen = searchLen;
+    rule->replaceLen = strlen(replace);
+    rule->mode = mode;
+    if(rules->ignoreCase) foldText(rule->search, searchLen);
+    rules->hasSuffixRules |= (mode == 2);
+    rules->ruleCount++;
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Reads all rules of a rules file.
+ *
+ * @param rules
+ *      RuleSet receiving the rules.
+ *
+ * @param path
+ *      Path of the rules file.
+ *
+ * @param wildcard
+ *      Boolean value indicating whether the w flag is entered, in which case every search text must be a
+ *      valid prefix/suffix.
+ *
+ * @return
+ *      0 if all rules are loaded, FR_RULES_FILE_INVALID if the file can't be read or a line is not a rule,
+ *      FR_WILDCARD_INVALID if the w flag is entered and a search text is invalid.
+ */
+int loadRules(RuleSet *rules, const char *path, bool wildcard){
+    FILE *rulesFile = fopen(path, "r");
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    ssize_t lineLen;
+    int error = rulesFile ? 0 : FR_RULES_FILE_INVALID;
+
+    while(!error && (lineLen = getline(&line, &lineCapacity, rulesFile)) != -1){
+        if(lineLen && line[lineLen - 1] == '\n') line[--lineLen] = '\0';
+        if(lineLen && line[lineLen - 1] == '\r') line[--lineLen] = '\0';
+        if(!lineLen || line[0] == '#') continue;
+
+        char *tab = strchr(line, '\t');
+        if(!tab){
+            error = FR_RULES_FILE_INVALID;
+            break;
+        }
+        *tab = '\0';
+
+        size_t searchLen = tab - line;
+        if(!searchLen){
+            error = FR_RULES_FILE_INVALID;
+            break;
+        }
+
+        bool doubleAsterisk = line[0] == '*' && line[searchLen - 1] == '*', noAsterisk = line[0] != '*' && line[searchLen - 1] != '*';
+        if(wildcard && (doubleAsterisk || noAsterisk)) error = FR_WILDCARD_INVALID;
+        else if(!addRule(rules, line, tab + 1)) error = FR_RULES_FILE_INVALID;
+    }
+
+    free(line);
+    if(rulesFile) fclose(rulesFile);
+    if(!error && !rules->ruleCount) error = FR_RULES_FILE_INVALID;
+    return error;
+}
+
+
+/**
+ * @brief
+ *      Builds the Aho-Corasick automaton of all search texts as a DFA.
+ *
+ * @note
+ *      The trie of the search texts is built first. A breadth-first pass then fills every missing transition
+ *      with the transition of the failure state, so the scan never follows failure links. longestRule of a
+ *      state is the longest rule whose search text ends at that state (directly or through its failure states).
+ *
+ * @param rules
+ *      RuleSet with at least one rule.
+ *
+ * @return
+ *      False if the automaton couldn't be allocated.
+ */
+bool buildAutomaton(RuleSet *rules){
+    size_t maxStates = 1;
+    int classCount = 1;
+
+    memset(rules->byteClass, 0, sizeof(rules->byteClass));
+    for(size_t r = 0; r < rules->ruleCount; r++){
+        maxStates += rules->rules[r].searchLen;
+        for(size_t i = 0; i < rules->rules[r].searchLen; i++){
+            unsigned char byte = rules->rules[r].search[i];
+            if(!rules->byteClass[byte]) rules->byteClass[byte] = classCount++;
+        }
+    }
+    for(int c = 'A'; rules->ignoreCase && c <= 'Z'; c++) rules->byteClass[c] = rules->byteClass[foldByte(c)];
+
+    int32_t *next = calloc(maxStates * classCount, sizeof(int32_t)), *depth = calloc(maxStates, sizeof(int32_t)),
+            *longestRule = malloc(maxStates * sizeof(int32_t)), *fail = calloc(maxStates, sizeof(int32_t)),
+            *queue = malloc(maxStates * sizeof(int32_t));
+    size_t stateCount = 1;
+
+    if(!next || !depth || !longestRule || !fail || !queue){
+        free(next);
+        free(depth);
+        free(longestRule);
+        free(fail);
+        free(queue);
+        return false;
+    }
+    for(size_t s = 0; s < maxStates; s++) longestRule[s] = -1;
+
+    //Trie of the search texts. Transition 0 means "none" here, since no edge leads back to the root.
+    for(size_t r = 0; r < rules->ruleCount; r++){
+        int32_t state = 0;
+        for(size_t i = 0; i < rules->rules[r].searchLen; i++){
+            int32_t *edge = next + state * classCount + rules->byteClass[(unsigned char)rules->rules[r].search[i]];
+            if(!*edge){
+                depth[stateCount] = depth[state] + 1;
+                *edge = stateCount++;
+            }
+            state = *edge;
+        }
+        //Duplicate search texts keep the first rule.
+        if(longestRule[state] < 0) longestRule[state] = r;
+    }
+
+    //Breadth-first pass that fills the missing transitions and inherits the rules of the failure states.
+    size_t head = 0, tail = 0;
+    for(int c = 0; c < classCount; c++){
+        if(next[c]) queue[tail++] = next[c];
+    }
+    while(head < tail){
+        int32_t state = queue[head++], failState = fail[state];
+
+        if(longestRule[state] < 0) longestRule[state] = longestRule[failState];
+        for(int c = 0; c < classCount; c++){
+            int32_t *edge = next + state * classCount + c;
+            if(*edge){
+                fail[*edge] = next[failState * classCount + c];
+                queue[tail++] = *edge;
+            }
+            else *edge = next[failState * classCount + c];
+        }
+    }
+
+    free(fail);
+    free(queue);
+    rules->next = next;
+    rules->depth = depth;
+    rules->longestRule = longestRule;
+    rules->classCount = classCount;
+    rules->stateCount = stateCount;
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Finds the leftmost match of all rules, preferring the longest search text among matches that start at
+ *      the same position.
+ *
+ * @note
+ *      Once a match is found, the scan goes on only while a match starting at or before it could still be
+ *      ahead, i.e. while the current state is deep enough to reach back to it.
+ *
+ * @param rules
+ *      RuleSet with a built automaton.
+ *
+ * @param texts
+ *      Texts to be searched.
+ *
+ * @param textsLen
+ *      Number of characters in texts.
+ *
+ * @param from
+ *      Offset where the search begins.
+ *
+ * @param complete
+ *      Boolean value indicating whether texts reach the end of the line. Otherwise a longer match might still
+ *      be completed by the texts that follow.
+ *
+ * @param start
+ *      Pointer that is set to the offset of the match (MATCH_FOUND), or to the first offset where a match
+ *      could still begin if texts went on (MATCH_NONE and MATCH_UNDECIDED).
+ *
+ * @param rule
+ *      Pointer that is set to the index of the matched rule.
+ *
+ * @return
+ *      MATCH_FOUND, MATCH_NONE, or MATCH_UNDECIDED if the best match can't be known before texts go on.
+ */
+int findLeftmostLongest(const RuleSet *rules, const char *texts, size_t textsLen, size_t from, bool complete, size_t *start,
+    int *rule){
+    const unsigned char *bytes = (const unsigned char *)texts;
+    int32_t state = 0, bestRule = -1;
+    size_t bestStart = 0;
+
+    for(size_t i = from; i < textsLen; i++){
+        state = rules->next[state * rules->classCount + rules->byteClass[bytes[i]]];
+
+        int32_t found = rules->longestRule[state];
+        if(found >= 0){
+            size_t foundStart = i + 1 - rules->rules[found].searchLen;
+            if(bestRule < 0 || foundStart < bestStart || (foundStart == bestStart && rules->rules[found].searchLen > rules->rules[bestRule].searchLen)){
+                bestRule = found;
+                bestStart = foundStart;
+            }
+        }
+
+        //No match that starts at or before bestStart can end after this position.
+        if(bestRule >= 0 && i + 1 - rules->depth[state] > bestStart){
+            *start = bestStart;
+            *rule = bestRule;
+            return MATCH_FOUND;
+        }
+    }
+
+    *rule = bestRule;
+    if(bestRule >= 0 && complete){
+        *start = bestStart;
+        return MATCH_FOUND;
+    }
+
+    *start = textsLen - rules->depth[state];
+    return bestRule < 0 ? MATCH_NONE : MATCH_UNDECIDED;
+}
+
+
+/**
+ * @brief
+ *      Frees all rules and the automaton.
+ *
+ * @param rules
+ *      RuleSet to be freed.
+ */
+void freeRules(RuleSet *rules){
+    for(size_t r = 0; r < rules->ruleCount; r++){
+        free(rules->rules[r].search);
+        free(rules->rules[r].replace);
+    }
+    free(rules->rules);
+    free(rules->next);
+    free(rules->depth);
+    free(rules->longestRule);
+    memset(rules, 0, sizeof(RuleSet));
+}
@@ -0,0 +1,317 @@
+/**
+ * @file ParallelReplace.c
+ *
+ * @brief
+ *      Performs the find/replace function of a memory-mapped input file on several worker threads (j flag).
+ *
+ * @note
+ *      The input is split into chunks that end right after a '\n', so every chunk only contains whole lines
+ *      and gives the same output as the single-threaded run. When the l flag is used, the newlines of every
+ *      chunk are counted first, and a prefix sum of those counts gives the line number each chunk starts at.
+ *      The workers copy the output of a chunk into memory, and the main thread writes the chunks in order.
+ *      At most CHUNK_WINDOW chunks per thread are processed ahead of the one being written, which bounds the
+ *      memory used no matter the file size.
+ * @note
+ *      Every worker thread adds up the counters of its chunks (--stats), and records them once it is done.
+ *      The bytes written are counted by the main thread, as the chunks are written.
+ */
+#include "FindReplace.h"
+
+//Number of chunks per thread a file is split into (when the chunks are above MIN_CHUNK_SIZE)
+#define CHUNKS_PER_THREAD 8
+
+//Number of chunks per thread that may be processed ahead of the chunk being written
+#define CHUNK_WINDOW 4
+
+/*
+Chunk is a part of the input file that only contains whole lines. failed is set when its output couldn't be kept in
+memory completely.
+*/
+typedef struct {
+    const char *texts;
+    size_t textsLen;
+    long long firstLine, newlineCount;
+    char *memory;
+    size_t memoryLen;
+    bool passThrough, failed, done;
+} Chunk;
+
+/*
+ChunkQueue hands the chunks to the worker threads in order. Each worker takes one of the contexts, which are
+allocated before any thread starts.
+*/
+typedef struct {
+    const fr_pattern *pattern;
+    int outputFd;
+    Chunk *chunks;
+    fr_context *contexts;
+    size_t chunkCount, nextChunk, writtenChunks, window, workers;
+    bool counting, failed;
+    fr_stats stats;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} ChunkQueue;
+
+
+/**
+ * @brief
+ *      Splits texts into chunks that end right after a '\n' (or at the end of texts).
+ *
+ * @param texts
+ *      Beginning of the mapped input file.
+ *
+ * @param textsLen
+ *      Number of characters in the mapped input file.
+ *
+ * @param threads
+ *      Number of worker threads.
+ *
+ * @param chunkCount
+ *      Pointer that is set to the number of chunks.
+ *
+ * @return
+ *      Array of chunks, or NULL if it couldn't be allocated.
+ */
+static Chunk *splitChunks(const char *texts, size_t textsLen, int threads, size_t *chunkCount){
+    size_t chunkSize = textsLen / ((size_t)threads * CHUNKS_PER_THREAD), capacity = (size_t)threads * CHUNKS_PER_THREAD, pos = 0;
+    if(chunkSize < MIN_CHUNK_SIZE) chunkSize = MIN_CHUNK_SIZE;
+
+    Chunk *chunks = malloc(capacity * sizeof(Chunk));
+    *chunkCount = 0;
+
+    while(chunks && pos < textsLen){
+        size_t end = textsLen - pos > chunkSize ? pos + chunkSize : textsLen;
+        if(end < textsLen){
+            const char *newline = memchr(texts + end - 1, '\n', textsLen - (end - 1));
+            end = newline ? (size_t)(newline - texts) + 1 : textsLen;
+        }
+
+        if(*chunkCount == capacity){
+            Chunk *larger = realloc(chunks, capacity * 2 * sizeof(Chunk));
+            if(!larger){
+                free(chunks);
+                return NULL;
+            }
+            chunks = larger;
+            capacity *= 2;
+        }
+
+        chunks[(*chunkCount)++] = (Chunk){.texts = texts + pos, .textsLen = end - pos, .firstLine = 1};
+        pos = end;
+    }
+    return chunks;
+}
+
+
+/**
+ * @brief
+ *      Counts the '\n' in a chunk, with the newline kernel (see skipNewlines()).
+ *
+ * @param chunk
+ *      Chunk to be counted.
+ */
+static void countNewlines(Chunk *chunk){
+    long long lines = LLONG_MAX;
+
+    skipNewlines(chunk->texts, chunk->textsLen, &lines);
+    chunk->newlineCount = LLONG_MAX - lines;
+}
+
+
+/**
+ * @brief
+ *      Performs the find/replace function on a chunk and keeps its output in memory.
+ *
+ * @note
+ *      A chunk whose lines are all outside the range of the l flag is not copied at all. The main thread
+ *      writes it straight from the mapping.
+ *
+ * @param queue
+ *      ChunkQueue the chunk belongs to.
+ *
+ * @param chunk
+ *      Chunk to be processed.
+ *
+ * @param context
+ *      Context of the current thread, which is set up with a MEMORY_OUTPUT target for the chunk.
+ *
+ * @param workerStats
+ *      Counters of the current thread, which receive those of the chunk.
+ */
+static void replaceChunk(ChunkQueue *queue, Chunk *chunk, fr_context *context, fr_stats *workerStats){
+    const int *start_end_lines = queue->pattern->start_end_lines;
+    long long lastLine = chunk->firstLine + chunk->newlineCount;
+
+    if(lastLine < start_end_lines[0] || chunk->firstLine > start_end_lines[1]){
+        //The lines before the range count as scanned, as replaceLines() counts those it skips.
+        if(lastLine < start_end_lines[0]) COUNT_STAT(workerStats, linesScanned, chunk->newlineCount);
+        chunk->passThrough = true;
+        return;
+    }
+
+    initContext(context, queue->pattern, MEMORY_OUTPUT);
+    context->lineNum = chunk->firstLine;
+
+    replaceLines(context, chunk->texts, chunk->textsLen, true);
+    releaseContext(context);
+
+    chunk->memory = context->output.memory;
+    chunk->memoryLen = context->output.memoryLen;
+    chunk->failed = context->output.failed;
+
+    //The output kept in memory is only counted once the main thread writes it.
+    context->stats.bytesWritten = 0;
+    addStats(workerStats, &context->stats);
+}
+
+
+/**
+ * @brief
+ *      Worker thread that takes the next chunk from the queue until all chunks are taken.
+ *
+ * @param arg
+ *      ChunkQueue shared by all threads.
+ *
+ * @return
+ *      NULL.
+ */
+static void *chunkWorker(void *arg){
+    ChunkQueue *queue = arg;
+    fr_stats workerStats = {0};
+
+    pthread_mutex_lock(&queue->lock);
+    fr_context *context = queue->contexts + queue->workers++;
+    while(true){
+        //Waits while the chunk is too far ahead of the one being written.
+        while(!queue->counting && queue->nextChunk < queue->chunkCount && queue->nextChunk >= queue->writtenChunks + queue->window)
+            pthread_cond_wait(&queue->changed, &queue->lock);
+        if(queue->nextChunk >= queue->chunkCount) break;
+
+        Chunk *chunk = queue->chunks + queue->nextChunk++;
+        pthread_mutex_unlock(&queue->lock);
+
+        if(queue->counting) countNewlines(chunk);
+        else replaceChunk(queue, chunk, context, &workerStats);
+
+        pthread_mutex_lock(&queue->lock);
+        chunk->done = true;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    recordStats(&workerStats);
+    return NULL;
+}
+
+
+/**
+ * @brief
+ *      Runs the worker threads over all chunks of the queue.
+ *
+ * @note
+ *      While replacing, the calling thread writes the output of every chunk in order as soon as it is done.
+ *
+ * @param queue
+ *      ChunkQueue to be processed.
+ *
+ * @param threads
+ *      Number of worker threads.
+ */
+static void runWorkers(ChunkQueue *queue, int threads){
+    pthread_t workers[MAX_THREADS];
+    int started = 0;
+
+    queue->nextChunk = queue->writtenChunks = queue->workers = 0;
+    for(size_t i = 0; i < queue->chunkCount; i++) queue->chunks[i].done = false;
+
+    while(started < threads && !pthread_create(workers + started, NULL, chunkWorker, queue)) started++;
+    //Without any worker thread, the calling thread processes the chunks by itself.
+    if(!started){
+        queue->window = queue->chunkCount;
+        chunkWorker(queue);
+    }
+
+    for(size_t i = 0; !queue->counting && i < queue->chunkCount; i++){
+        Chunk *chunk = queue->chunks + i;
+
+        pthread_mutex_lock(&queue->lock);
+        while(!chunk->done) pthread_cond_wait(&queue->changed, &queue->lock);
+        pthread_mutex_unlock(&queue->lock);
+
+        //Once a write fails, or a chunk misses some of its output, the remaining chunks are still waited for but no longer written.
+        if(chunk->failed) queue->failed = true;
+        const char *texts = chunk->passThrough ? chunk->texts : chunk->memory;
+        size_t textsLen = chunk->passThrough ? chunk->textsLen : chunk->memoryLen;
+        if(!queue->failed){
+            TIME_STAT(&queue->stats, outputSeconds, queue->failed = !writeAll(queue->outputFd, texts, textsLen));
+            COUNT_STAT(&queue->stats, bytesWritten, textsLen);
+        }
+        free(chunk->memory);
+
+        pthread_mutex_lock(&queue->lock);
+        queue->writtenChunks++;
+        pthread_cond_broadcast(&queue->changed);
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    for(int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+}
+
+
+/**
+ * @brief
+ * Performs the corresponding find/replace function on a memory-mapped input file with several threads.
+ *
+ * @param pattern
+ *      Compiled pattern of the search/replace function.
+ *
+ * @param texts
+ *      Beginning of the mapped input file.
+ *
+ * @param textsLen
+ *      Number of characters in the mapped input file.
+ *
+ * @param threads
+ *      Number of worker threads.
+ *
+ * @return
+ *      False if the output couldn't be written completely.
+ */
+bool parallelFindReplace(const fr_pattern *pattern, const char *texts, size_t textsLen, int threads){
+    const int *start_end_lines = pattern->start_end_lines;
+    ChunkQueue queue = {.pattern = pattern, .outputFd = fileno(outputFile), .window = (size_t)threads * CHUNK_WINDOW};
+
+    queue.chunks = splitChunks(texts, textsLen, threads, &queue.chunkCount);
+    queue.contexts = queue.chunks ? malloc((size_t)threads * sizeof(fr_context)) : NULL;
+    if(!queue.contexts){
+        free(queue.chunks);
+        return mappedFindReplace(pattern, texts, textsLen);
+    }
+
+    queue.failed = fflush(outputFile);
+    pthread_mutex_init(&queue.lock, NULL);
+    pthread_cond_init(&queue.changed, NULL);
+
+    //Line numbers only matter when the l flag narrows the range.
+    if(start_end_lines[0] > 1 || start_end_lines[1] < INT_MAX){
+        queue.counting = true;
+        runWorkers(&queue, threads);
+        queue.counting = false;
+
+        for(size_t i = 1; i < queue.chunkCount; i++)
+            queue.chunks[i].firstLine = queue.chunks[i - 1].firstLine + queue.chunks[i - 1].newlineCount;
+    }
+    else{
+        //Every line is in range, so each chunk may count its lines from 1.
+        for(size_t i = 0; i < queue.chunkCount; i++) queue.chunks[i].newlineCount = 0;
+    }
+
+    runWorkers(&queue, threads);
+    recordStats(&queue.stats);
+
+    pthread_cond_destroy(&queue.changed);
+    pthread_mutex_destroy(&queue.lock);
+    free(queue.contexts);
+    free(queue.chunks);
+    return !queue.failed;
+}
@@ -0,0 +1,1344 @@
+/**
+ * @file Regex.c
+ *
+ * @brief
+ *      Compiles the search text of the E flag (an extended regular expression) into a forward and a reverse NFA,
+ *      and finds its leftmost-longest matches with DFAs that are built lazily, one state at a time.
+ *
+ * @note
+ *      Syntax: literal bytes, '.', bracket expressions ([a-z], [^0-9], [[:alpha:]]), \w \W \s \S \d \D, \n \t,
+ *      escaped special characters, '^', '$', groups, '|' and the repetitions *, +, ?, {m}, {m,} and {m,n}.
+ *      Back-references and word boundaries are not regular, so they are rejected.
+ * @note
+ *      A line is searched in two passes: the reverse DFA reads it backwards once and marks every offset where a
+ *      match begins, then the forward DFA reads each match from its beginning until it can't match any longer, to
+ *      find its longest end. A scan that reaches the state of the previous scan at one of its checkpoints takes the
+ *      rest from it, so the matches of a line whose scans run past their ends (ex. a+c|a on a line of a) don't read
+ *      the line again and again. Scans that never meet (ex. (aa)+c|a) still read the texts after each match again,
+ *      so the worst case is O(line length * matches). The groups of a match are only found (by a Pike VM over the
+ *      match alone) when the replacement text uses them. Every DFA keeps at most REGEX_CACHE_STATES states, so its
+ *      memory doesn't grow with the input.
+ */
+#include "Engine.h"
+
+//Kinds of RegexNode
+#define NODE_EMPTY 0
+#define NODE_SET 1
+#define NODE_CONCAT 2
+#define NODE_ALTERNATE 3
+#define NODE_REPEAT 4
+#define NODE_GROUP 5
+#define NODE_LINE_START 6
+#define NODE_LINE_END 7
+
+//Offset of a group that took no part in a match, or of a match that doesn't exist
+#define NO_OFFSET SIZE_MAX
+
+//Slots of the offsets of all groups (see INST_SAVE)
+#define GROUP_SLOTS (2 * REGEX_GROUPS)
+
+/*
+RegexNode is a node of the syntax tree of a regex.
+- NODE_SET: matches a byte of the byte set arg.
+- NODE_CONCAT: matches its count items (items[arg] to items[arg + count - 1] of the parser) one after another.
+- NODE_ALTERNATE: matches left or right.
+- NODE_REPEAT: matches left min to max times (max = -1 without a limit).
+- NODE_GROUP: matches left as group arg.
+*/
+typedef struct {
+    int kind, arg, left, right, min, max, count;
+} RegexNode;
+
+/*
+RegexParser holds the syntax tree of a regex while it is parsed. error is the first error encountered. With
+ignoreCase (i flag), every byte set holds both cases of its letters.
+*/
+typedef struct {
+    const char *search;
+    size_t pos, searchLen;
+    RegexNode *nodes;
+    int nodeCount, nodeCapacity;
+    int *items;
+    int itemCount, itemCapacity;
+    Regex *regex;
+    int depth, error;
+    bool ignoreCase;
+} RegexParser;
+
+//Character classes of bracket expressions ([:alpha:], etc.)
+static const struct {
+    const char *name;
+    int (*test)(int);
+} charClasses[] = {
+    {"alpha", isalpha}, {"digit", isdigit}, {"alnum", isalnum}, {"upper", isupper}, {"lower", islower},
+    {"space", isspace}, {"blank", isblank}, {"punct", ispunct}, {"print", isprint}, {"graph", isgraph},
+    {"cntrl", iscntrl}, {"xdigit", isxdigit},
+};
+
+
+static void addByte(uint64_t *set, unsigned char byte){
+    set[byte >> 6] |= 1ULL << (byte & 63);
+}
+
+
+static bool hasByte(const uint64_t *set, unsigned char byte){
+    return set[byte >> 6] >> (byte & 63) & 1;
+}
+
+
+/**
+ * @brief
+ *      Adds the bytes that pass a ctype test to a byte set.
+ */
+static void addClass(uint64_t *set, int (*test)(int)){
+    for(int c = 0; c <= UCHAR_MAX; c++){
+        if(test(c)) addByte(set, c);
+    }
+}
+
+
+/**
+ * @brief
+ *      Finds the ctype test of a character class by its name.
+ *
+ * @return
+ *      Test of the class, or NULL if there is no such class.
+ */
+static int (*findCharClass(const char *name, size_t nameLen))(int){
+    for(size_t k = 0; k < sizeof(charClasses) / sizeof(*charClasses); k++){
+        if(strlen(charClasses[k].name) == nameLen && !memcmp(charClasses[k].name, name, nameLen)) return charClasses[k].test;
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief
+ *      Replaces a byte set by the bytes it lacks. A line never contains '\n', so it stays out of the set.
+ */
+static void complementSet(uint64_t *set){
+    for(int w = 0; w < 4; w++) set[w] = ~set[w];
+    set['\n' >> 6] &= ~(1ULL << ('\n' & 63));
+}
+
+
+/**
+ * @brief
+ *      Adds the other case of every letter of a byte set when the regex ignores case.
+ */
+static void foldSet(const RegexParser *parser, uint64_t *set){
+    for(int c = 'a'; parser->ignoreCase && c <= 'z'; c++){
+        if(hasByte(set, c) || hasByte(set, c - 0x20)){
+            addByte(set, c);
+            addByte(set, c - 0x20);
+        }
+    }
+}
+
+
+static int isWordChar(int c){
+    return isalnum(c) || c == '_';
+}
+
+
+/**
+ * @brief
+ *      Records the first error of a parse.
+ *
+ * @return
+ *      -1, which stands for the node that couldn't be parsed.
+ */
+static int failParse(RegexParser *parser, int error){
+    if(!parser->error) parser->error = error;
+    return -1;
+}
+
+
+/**
+ * @brief
+ *      Adds a node to the syntax tree.
+ *
+ * @return
+ *      Index of the node, or -1 if the parse already failed or the node couldn't be allocated.
+ */
+static int addNode(RegexParser *parser, int kind, int arg, int left, int right){
+    if(parser->error) return -1;
+
+    if(parser->nodeCount == parser->nodeCapacity){
+        int capacity = parser->nodeCapacity ? parser->nodeCapacity * 2 : 64;
+        RegexNode *larger = realloc(parser->nodes, capacity * sizeof(RegexNode));
+        if(!larger) return failParse(parser, FR_OUT_OF_MEMORY);
+        parser->nodes = larger;
+        parser->nodeCapacity = capacity;
+    }
+
+    RegexNode *node = parser->nodes + parser->nodeCount;
+    *node = (RegexNode){.kind = kind, .arg = arg, .left = left, .right = right};
+    return parser->nodeCount++;
+}
+
+
+/**
+ * @brief
+ *      Adds a node that matches a byte of a byte set, which is copied into the byte sets of the regex.
+ *
+ * @return
+ *      Index of the node, or -1 if it couldn't be allocated.
+ */
+static int addSetNode(RegexParser *parser, const uint64_t *set){
+    Regex *regex = parser->regex;
+
+    if(parser->error) return -1;
+
+    if(regex->setCount == regex->setCapacity){
+        int capacity = regex->setCapacity ? regex->setCapacity * 2 : 16;
+        uint64_t (*larger)[4] = realloc(regex->sets, capacity * sizeof(*regex->sets));
+        if(!larger) return failParse(parser, FR_OUT_OF_MEMORY);
+        regex->sets = larger;
+        regex->setCapacity = capacity;
+    }
+
+    memcpy(regex->sets[regex->setCount], set, sizeof(*regex->sets));
+    foldSet(parser, regex->sets[regex->setCount]);
+    return addNode(parser, NODE_SET, regex->setCount++, -1, -1);
+}
+
+
+/**
+ * @brief
+ *      Parses the escape sequence after a '\' outside of a bracket expression.
+ *
+ * @return
+ *      Index of its node, or -1 if it is invalid.
+ */
+static int parseEscape(RegexParser *parser){
+    uint64_t set[4] = {0};
+
+    if(parser->pos == parser->searchLen) return failParse(parser, FR_REGEX_INVALID);
+
+    unsigned char c = parser->search[parser->pos++];
+    if(c == 'd' || c == 'D') addClass(set, isdigit);
+    else if(c == 'w' || c == 'W') addClass(set, isWordChar);
+    else if(c == 's' || c == 'S') addClass(set, isspace);
+    else if(c == 'n') addByte(set, '\n');
+    else if(c == 't') addByte(set, '\t');
+    else if(isdigit(c) || strchr("bB<>`'", c)) return failParse(parser, FR_REGEX_INVALID);
+    else addByte(set, c);
+
+    if(c == 'D' || c == 'W' || c == 'S') complementSet(set);
+    return addSetNode(parser, set);
+}
+
+
+/**
+ * @brief
+ *      Parses a bracket expression, right after its '['.
+ *
+ * @note
+ *      As in POSIX, a ']' right after the '[' (or "[^") is a member, and a '\' is a member like any other byte.
+ *
+ * @return
+ *      Index of its node, or -1 if it is invalid.
+ */
+static int parseBracket(RegexParser *parser){
+    const char *search = parser->search;
+    uint64_t set[4] = {0};
+    bool negate = parser->pos < parser->searchLen && search[parser->pos] == '^', first = true;
+
+    parser->pos += negate;
+    while(true){
+        if(parser->pos == parser->searchLen) return failParse(parser, FR_REGEX_INVALID);
+
+        unsigned char c = search[parser->pos];
+        if(c == ']' && !first){
+            parser->pos++;
+            break;
+        }
+        first = false;
+
+        //[:name:] names a character class. [=x=] and [.x.] are not supported.
+        if(c == '[' && parser->pos + 1 < parser->searchLen && strchr(":=.", search[parser->pos + 1])){
+            const char *name = search + parser->pos + 2,
+                *end = memmem(name, parser->searchLen - parser->pos - 2, ":]", 2);
+            int (*test)(int) = end && search[parser->pos + 1] == ':' ? findCharClass(name, end - name) : NULL;
+
+            if(!test) return failParse(parser, FR_REGEX_INVALID);
+            addClass(set, test);
+            parser->pos = end + 2 - search;
+            continue;
+        }
+
+        unsigned char last = c;
+        parser->pos++;
+        if(parser->pos + 1 < parser->searchLen && search[parser->pos] == '-' && search[parser->pos + 1] != ']'){
+            last = search[parser->pos + 1];
+            parser->pos += 2;
+            if(last < c) return failParse(parser, FR_REGEX_INVALID);
+        }
+        for(int b = c; b <= last; b++) addByte(set, b);
+    }
+
+    //[^a] lacks both cases of a letter when the regex ignores case.
+    foldSet(parser, set);
+    if(negate) complementSet(set);
+    return addSetNode(parser, set);
+}
+
+
+static int parseAlternation(RegexParser *parser);
+
+
+/**
+ * @brief
+ *      Parses an atom: a byte, a byte set, an anchor or a group.
+ *
+ * @return
+ *      Index of its node, or -1 if it is invalid.
+ */
+static int parseAtom(RegexParser *parser){
+    uint64_t set[4] = {0};
+    unsigned char c = parser->search[parser->pos++];
+
+    if(c == '('){
+        int group = ++parser->regex->groupCount;
+        if(++parser->depth > REGEX_MAX_DEPTH) return failParse(parser, FR_REGEX_INVALID);
+
+        int inner = parseAlternation(parser);
+        if(parser->pos == parser->searchLen || parser->search[parser->pos] != ')') return failParse(parser, FR_REGEX_INVALID);
+        parser->pos++;
+        parser->depth--;
+        return addNode(parser, NODE_GROUP, group, inner, -1);
+    }
+    if(c == '[') return parseBracket(parser);
+    if(c == '\\') return parseEscape(parser);
+    if(c == '^') return addNode(parser, NODE_LINE_START, 0, -1, -1);
+    if(c == '$') return addNode(parser, NODE_LINE_END, 0, -1, -1);
+
+    //A repetition needs something to repeat.
+    if(strchr("*+?{", c)) return failParse(parser, FR_REGEX_INVALID);
+
+    //'.' is every byte but '\n', i.e. the complement of the empty set.
+    if(c == '.') complementSet(set);
+    else addByte(set, c);
+    return addSetNode(parser, set);
+}
+
+
+/**
+ * @brief
+ *      Parses the bounds of a {m}, {m,} or {m,n} repetition, from its '{' to its '}'.
+ *
+ * @return
+ *      False if the bounds are invalid.
+ */
+static bool parseBounds(RegexParser *parser, int *min, int *max){
+    const char *search = parser->search;
+    size_t pos = parser->pos + 1;
+    long bounds[2] = {-1, -1};
+
+    for(int b = 0; b < 2; b++){
+        if(pos < parser->searchLen && isdigit((unsigned char)search[pos])){
+            bounds[b] = 0;
+            while(pos < parser->searchLen && isdigit((unsigned char)search[pos]) && bounds[b] <= REGEX_MAX_INSTS){
+                bounds[b] = bounds[b] * 10 + search[pos++] - '0';
+            }
+        }
+        if(b == 0 && pos < parser->searchLen && search[pos] == ',') pos++;
+        else if(b == 0) bounds[1] = bounds[0];
+        else break;
+    }
+
+    if(pos == parser->searchLen || search[pos] != '}' || bounds[0] < 0) return false;
+    if(bounds[0] > REGEX_MAX_INSTS || bounds[1] > REGEX_MAX_INSTS || (bounds[1] >= 0 && bounds[1] < bounds[0])) return false;
+
+    *min = bounds[0];
+    *max = bounds[1];
+    parser->pos = pos;
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Parses an atom followed by any number of repetitions.
+ *
+ * @return
+ *      Index of its node, or -1 if it is invalid.
+ */
+static int parseRepeat(RegexParser *parser){
+    int node = parseAtom(parser);
+
+    while(!parser->error && parser->pos < parser->searchLen){
+        char c = parser->search[parser->pos];
+        int min = c == '+', max = c == '?' ? 1 : -1;
+
+        if(c == '{' && !parseBounds(parser, &min, &max)) return failParse(parser, FR_REGEX_INVALID);
+        if(!strchr("*+?{", c)) break;
+
+        parser->pos++;
+        node = addNode(parser, NODE_REPEAT, 0, node, -1);
+        if(node >= 0){
+            parser->nodes[node].min = min;
+            parser->nodes[node].max = max;
+        }
+    }
+    return node;
+}
+
+
+/**
+ * @brief
+ *      Makes room for count more items of concatenations.
+ *
+ * @return
+ *      False if the items couldn't be enlarged.
+ */
+static bool reserveItems(RegexParser *parser, int count){
+    if(parser->itemCount + count <= parser->itemCapacity) return true;
+
+    int capacity = 2 * (parser->itemCount + count);
+    int *larger = realloc(parser->items, capacity * sizeof(int));
+    if(!larger) return false;
+    parser->items = larger;
+    parser->itemCapacity = capacity;
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Parses the items of an alternative, up to the next '|' or ')'.
+ *
+ * @return
+ *      Index of its node, or -1 if it is invalid.
+ */
+static int parseConcat(RegexParser *parser){
+    int *items = NULL, count = 0, capacity = 0, node;
+
+    while(!parser->error && parser->pos < parser->searchLen && !strchr("|)", parser->search[parser->pos])){
+        int item = parseRepeat(parser);
+
+        if(count == capacity){
+            int *larger = realloc(items, (capacity = capacity ? capacity * 2 : 8) * sizeof(int));
+            if(!larger){
+                failParse(parser, FR_OUT_OF_MEMORY);
+                break;
+            }
+            items = larger;
+        }
+        items[count++] = item;
+    }
+
+    //The items of a concatenation lie next to each other in parser->items, so they can be read both ways.
+    if(parser->error) node = -1;
+    else if(count == 0) node = addNode(parser, NODE_EMPTY, 0, -1, -1);
+    else if(count == 1) node = items[0];
+    else if(!reserveItems(parser, count)) node = failParse(parser, FR_OUT_OF_MEMORY);
+    else if((node = addNode(parser, NODE_CONCAT, parser->itemCount, -1, -1)) >= 0){
+        memcpy(parser->items + parser->itemCount, items, count * sizeof(int));
+        parser->itemCount += count;
+        parser->nodes[node].count = count;
+    }
+
+    free(items);
+    return node;
+}
+
+
+/**
+ * @brief
+ *      Parses alternatives separated by '|'.
+ *
+ * @return
+ *      Index of its node, or -1 if it is invalid.
+ */
+static int parseAlternation(RegexParser *parser){
+    int node = parseConcat(parser);
+
+    while(!parser->error && parser->pos < parser->searchLen && parser->search[parser->pos] == '|'){
+        parser->pos++;
+        int right = parseConcat(parser);
+        node = addNode(parser, NODE_ALTERNATE, 0, node, right);
+    }
+    return node;
+}
+
+
+/**
+ * @brief
+ *      Appends the literal texts that every match of a node begins with to the prefix of the regex.
+ *
+ * @note
+ *      When the regex ignores case, a set that only holds both cases of a letter is literal as well, and its
+ *      letter is appended folded, as the search texts of the i flag are.
+ *
+ * @return
+ *      True if the node is made of literal bytes only, so the prefix goes on with the node after it.
+ */
+static bool appendPrefix(const RegexParser *parser, int index, char *prefix, size_t *prefixLen){
+    const RegexNode *node = parser->nodes + index;
+
+    if(node->kind == NODE_EMPTY || node->kind == NODE_LINE_START) return true;
+    if(node->kind == NODE_GROUP) return appendPrefix(parser, node->left, prefix, prefixLen);
+    if(node->kind == NODE_CONCAT){
+        for(int i = 0; i < node->count; i++){
+            if(!appendPrefix(parser, parser->items[node->arg + i], prefix, prefixLen)) return false;
+        }
+        return true;
+    }
+
+    //A repetition begins with its first copy, but what follows it is unknown.
+    if(node->kind == NODE_REPEAT && node->min > 0) appendPrefix(parser, node->left, prefix, prefixLen);
+    if(node->kind != NODE_SET) return false;
+
+    const uint64_t *set = parser->regex->sets[node->arg];
+    int count = 0, byte = 0;
+    for(int c = 0; c <= UCHAR_MAX && count < 2; c++){
+        int folded = parser->ignoreCase ? foldByte(c) : c;
+        if(hasByte(set, c) && (!count || folded != byte)){
+            count++;
+            byte = folded;
+        }
+    }
+    if(count != 1) return false;
+
+    prefix[(*prefixLen)++] = byte;
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Adds an instruction to a program. It goes on to the instruction after it unless changed.
+ *
+ * @param error
+ *      Pointer that is set to FR_REGEX_INVALID when the program is too large, or FR_OUT_OF_MEMORY.
+ *
+ * @return
+ *      Index of the instruction, or -1 if it couldn't be added.
+ */
+static int32_t emitInst(RegexProgram *program, int kind, int arg, int *error){
+    if(program->instCount == REGEX_MAX_INSTS){
+        *error = FR_REGEX_INVALID;
+        return -1;
+    }
+    if(program->instCount == program->instCapacity){
+        int32_t capacity = program->instCapacity ? program->instCapacity * 2 : 64;
+        RegexInst *larger = realloc(program->insts, capacity * sizeof(RegexInst));
+        if(!larger){
+            *error = FR_OUT_OF_MEMORY;
+            return -1;
+        }
+        program->insts = larger;
+        program->instCapacity = capacity;
+    }
+
+    program->insts[program->instCount] = (RegexInst){kind, arg, program->instCount + 1, -1};
+    return program->instCount++;
+}
+
+
+static bool emitNode(const RegexParser *parser, RegexProgram *program, int index, bool reverse, int *error);
+
+
+/**
+ * @brief
+ *      Adds the instructions of a repetition: min copies of the node, then either a loop or max - min optional
+ *      copies, each of which leaves to the end of the repetition, so x{0,2} reads as (x(x)?)?.
+ *
+ * @return
+ *      False if the instructions couldn't be added.
+ */
+static bool emitRepeat(const RegexParser *parser, RegexProgram *program, const RegexNode *node, bool reverse,
+    int *error){
+    int32_t split, jump, chain = -1;
+
+    for(int i = 0; i < node->min; i++){
+        if(!emitNode(parser, program, node->left, reverse, error)) return false;
+    }
+
+    if(node->max < 0){
+        if((split = emitInst(program, INST_SPLIT, 0, error)) < 0 || !emitNode(parser, program, node->left, reverse, error)
+            || (jump = emitInst(program, INST_JUMP, 0, error)) < 0) return false;
+        program->insts[jump].next = split;
+        program->insts[split].alt = program->instCount;
+        return true;
+    }
+
+    //The splits are chained through their alt until the end of the repetition is known.
+    for(int i = node->min; i < node->max; i++){
+        if((split = emitInst(program, INST_SPLIT, 0, error)) < 0) return false;
+        program->insts[split].alt = chain;
+        chain = split;
+        if(!emitNode(parser, program, node->left, reverse, error)) return false;
+    }
+    while(chain >= 0){
+        int32_t previous = program->insts[chain].alt;
+        program->insts[chain].alt = program->instCount;
+        chain = previous;
+    }
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Adds the instructions of a node to a program (Thompson construction).
+ *
+ * @param reverse
+ *      Boolean value indicating whether the program reads the regex backwards.
+ *
+ * @param error
+ *      Pointer that is set to the error code if the instructions couldn't be added.
+ *
+ * @return
+ *      False if the instructions couldn't be added.
+ */
+static bool emitNode(const RegexParser *parser, RegexProgram *program, int index, bool reverse, int *error){
+    const RegexNode *node = parser->nodes + index;
+    int32_t split, jump;
+
+    switch(node->kind){
+        case NODE_SET:
+            return emitInst(program, INST_BYTE, node->arg, error) >= 0;
+        case NODE_LINE_START:
+        case NODE_LINE_END: {
+            //Read backwards, a line begins where it ends.
+            bool lineStart = (node->kind == NODE_LINE_START) != reverse;
+            return emitInst(program, lineStart ? INST_LINE_START : INST_LINE_END, 0, error) >= 0;
+        }
+        case NODE_GROUP:
+            return emitInst(program, INST_SAVE, 2 * node->arg + reverse, error) >= 0 &&
+                emitNode(parser, program, node->left, reverse, error) &&
+                emitInst(program, INST_SAVE, 2 * node->arg + !reverse, error) >= 0;
+        case NODE_CONCAT:
+            for(int i = 0; i < node->count; i++){
+                int item = parser->items[node->arg + (reverse ? node->count - 1 - i : i)];
+                if(!emitNode(parser, program, item, reverse, error)) return false;
+            }
+            return true;
+        case NODE_ALTERNATE:
+            if((split = emitInst(program, INST_SPLIT, 0, error)) < 0 || !emitNode(parser, program, node->left, reverse, error)
+                || (jump = emitInst(program, INST_JUMP, 0, error)) < 0) return false;
+            program->insts[split].alt = program->instCount;
+            if(!emitNode(parser, program, node->right, reverse, error)) return false;
+            program->insts[jump].next = program->instCount;
+            return true;
+        case NODE_REPEAT:
+            return emitRepeat(parser, program, node, reverse, error);
+    }
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Compiles the syntax tree of a regex into a program that ends with INST_MATCH.
+ *
+ * @return
+ *      FR_REGEX_INVALID if the program is too large, FR_OUT_OF_MEMORY, otherwise FR_OK.
+ */
+static int compileProgram(const RegexParser *parser, int root, RegexProgram *program, bool reverse){
+    int error = FR_OK;
+
+    program->start = 0;
+    if(emitNode(parser, program, root, reverse, &error)) emitInst(program, INST_MATCH, 0, &error);
+    return error;
+}
+
+
+/**
+ * @brief
+ *      Splits the bytes into the classes of bytes that no byte set of the regex tells apart. Every byte set is a
+ *      union of ranges, so a class is a range of bytes within which no byte set begins or ends.
+ */
+static void buildByteClasses(Regex *regex){
+    bool boundary[UCHAR_MAX + 1] = {false};
+    int classCount = 0;
+
+    for(int s = 0; s < regex->setCount; s++){
+        for(int c = 1; c <= UCHAR_MAX; c++){
+            if(hasByte(regex->sets[s], c) != hasByte(regex->sets[s], c - 1)) boundary[c] = true;
+        }
+    }
+    for(int c = 0; c <= UCHAR_MAX; c++){
+        if(c && boundary[c]) classCount++;
+        if(!c || boundary[c]) regex->classByte[classCount] = c;
+        regex->byteClass[c] = classCount;
+    }
+    regex->classCount = classCount + 1;
+}
+
+
+/**
+ * @brief
+ *      Splits a replacement text into literal texts and references to groups.
+ *
+ * @note
+ *      \0 to \9 and & stand for the texts matched by a group (0 and & for the whole match), \n and \t for a
+ *      newline and a tab, and a '\' before any other character stands for that character (ex. \& and \\).
+ *
+ * @return
+ *      FR_REPLACE_INVALID if a group doesn't exist, FR_OUT_OF_MEMORY, otherwise FR_OK.
+ */
+static int compileReplacement(Regex *regex, const char *replace){
+    size_t replaceLen = strlen(replace), textsLen = 0;
+
+    regex->replaceTexts = malloc(replaceLen + 1);
+    regex->parts = malloc((replaceLen + 1) * sizeof(ReplacePart));
+    if(!regex->replaceTexts || !regex->parts) return FR_OUT_OF_MEMORY;
+
+    for(size_t i = 0; i < replaceLen; i++){
+        char c = replace[i];
+        int group = c == '&' ? 0 : -1;
+
+        if(c == '\\' && i + 1 < replaceLen){
+            c = replace[++i];
+            if(isdigit((unsigned char)c)) group = c - '0';
+            else if(c == 'n') c = '\n';
+            else if(c == 't') c = '\t';
+        }
+
+        if(group > regex->groupCount) return FR_REPLACE_INVALID;
+        if(group >= 0){
+            regex->parts[regex->partCount++] = (ReplacePart){NULL, 0, group};
+            regex->groupsUsed |= group > 0;
+            continue;
+        }
+
+        //Literal characters in a row make up a single part.
+        if(!regex->partCount || regex->parts[regex->partCount - 1].group >= 0){
+            regex->parts[regex->partCount++] = (ReplacePart){regex->replaceTexts + textsLen, 0, -1};
+        }
+        regex->replaceTexts[textsLen++] = c;
+        regex->parts[regex->partCount - 1].textsLen++;
+    }
+    return FR_OK;
+}
+
+
+/**
+ * @brief
+ *      Compiles the search text of the E flag and its replacement text.
+ *
+ * @param regex
+ *      Regex receiving the programs, which is zeroed beforehand and freed by freeRegex() even on error.
+ *
+ * @param search
+ *      Regular expression.
+ *
+ * @param replace
+ *      Replacement text, which may refer to the groups of the regex.
+ *
+ * @param ignoreCase
+ *      Boolean value indicating whether the regex matches whatever the case of the ASCII letters (i flag).
+ *
+ * @param prefix
+ *      Pointer that is set to the literal texts every match begins with (empty if there are none), allocated.
+ *
+ * @param prefixLen
+ *      Pointer that is set to the number of characters in prefix.
+ *
+ * @return
+ *      FR_REGEX_INVALID if the regex is invalid or too large, FR_REPLACE_INVALID if the replacement text refers to
+ *      a group that doesn't exist, FR_OUT_OF_MEMORY, otherwise FR_OK.
+ */
+int compileRegex(Regex *regex, const char *search, const char *replace, bool ignoreCase, char **prefix, size_t *prefixLen){
+    RegexParser parser = {.search = search, .searchLen = strlen(search), .regex = regex, .ignoreCase = ignoreCase};
+    int root = parseAlternation(&parser), error;
+
+    //The parse only stops early at a ')' without its '('.
+    if(!parser.error && parser.pos < parser.searchLen) parser.error = FR_REGEX_INVALID;
+
+    error = parser.error;
+    if(!error) error = compileProgram(&parser, root, &regex->forward, false);
+    if(!error) error = compileProgram(&parser, root, &regex->reverse, true);
+    if(!error) error = compileReplacement(regex, replace);
+    if(!error && !(*prefix = malloc(parser.searchLen + 1))) error = FR_OUT_OF_MEMORY;
+
+    if(!error){
+        *prefixLen = 0;
+        appendPrefix(&parser, root, *prefix, prefixLen);
+        (*prefix)[*prefixLen] = '\0';
+        buildByteClasses(regex);
+    }
+
+    free(parser.nodes);
+    free(parser.items);
+    return error;
+}
+
+
+/**
+ * @brief
+ *      Frees the programs and the replacement text of a regex.
+ *
+ * @param regex
+ *      Regex to be freed.
+ */
+void freeRegex(Regex *regex){
+    free(regex->forward.insts);
+    free(regex->reverse.insts);
+    free(regex->sets);
+    free(regex->parts);
+    free(regex->replaceTexts);
+    memset(regex, 0, sizeof(Regex));
+}
+
+
+/**
+ * @brief
+ *      Starts a new mark for the visited instructions, clearing the marks once the counter wraps around.
+ */
+static void nextMark(uint32_t *marks, uint32_t *mark, int32_t instCount){
+    if(++*mark) return;
+    memset(marks, 0, instCount * sizeof(uint32_t));
+    *mark = 1;
+}
+
+
+static int compareInsts(const void *a, const void *b){
+    int32_t left = *(const int32_t *)a, right = *(const int32_t *)b;
+    return (left > right) - (left < right);
+}
+
+
+/**
+ * @brief
+ *      Adds the set of instructions in dfa->work as a new state, without looking for it first.
+ *
+ * @return
+ *      Index of the state.
+ */
+static int32_t insertState(LazyDfa *dfa, uint32_t hash){
+    int32_t state = dfa->stateCount++, bucket = hash & dfa->bucketMask;
+
+    dfa->setOffsets[state] = dfa->poolLen;
+    dfa->setLens[state] = dfa->workLen;
+    if(dfa->workLen) memcpy(dfa->pool + dfa->poolLen, dfa->work, dfa->workLen * sizeof(int32_t));
+    dfa->poolLen += dfa->workLen;
+
+    dfa->accepting[state] = false;
+    for(int32_t i = 0; i < dfa->workLen; i++){
+        if(dfa->program->insts[dfa->work[i]].kind == INST_MATCH) dfa->accepting[state] = true;
+    }
+    memset(dfa->next + (size_t)state * dfa->stride, 0xff, dfa->stride * sizeof(int32_t));
+
+    while(dfa->buckets[bucket] >= 0) bucket = (bucket + 1) & dfa->bucketMask;
+    dfa->buckets[bucket] = state;
+    return state;
+}
+
+
+/**
+ * @brief
+ *      Throws away every state of a DFA but the empty set (state 0).
+ */
+static void resetDfa(LazyDfa *dfa){
+    dfa->stateCount = dfa->poolLen = 0;
+    dfa->startStates[0] = dfa->startStates[1] = -1;
+    dfa->generation++;
+    memset(dfa->buckets, 0xff, (dfa->bucketMask + 1) * sizeof(int32_t));
+
+    dfa->workLen = 0;
+    insertState(dfa, 2166136261u);
+}
+
+
+/**
+ * @brief
+ *      Finds the state of the set of instructions in dfa->work, or adds it. A full DFA is reset first (see
+ *      resetDfa()), which changes its generation.
+ *
+ * @return
+ *      Index of the state.
+ */
+static int32_t findState(LazyDfa *dfa){
+    uint32_t hash = 2166136261u;
+
+    qsort(dfa->work, dfa->workLen, sizeof(int32_t), compareInsts);
+    for(int32_t i = 0; i < dfa->workLen; i++) hash = (hash ^ (uint32_t)dfa->work[i]) * 16777619u;
+
+    for(int32_t bucket = hash & dfa->bucketMask; dfa->buckets[bucket] >= 0; bucket = (bucket + 1) & dfa->bucketMask){
+        int32_t state = dfa->buckets[bucket];
+        if(dfa->setLens[state] == dfa->workLen &&
+            !memcmp(dfa->pool + dfa->setOffsets[state], dfa->work, dfa->workLen * sizeof(int32_t))) return state;
+    }
+
+    if(dfa->stateCount == REGEX_CACHE_STATES || dfa->poolLen + dfa->workLen > dfa->poolCapacity){
+        int32_t workLen = dfa->workLen;
+        resetDfa(dfa);
+        dfa->workLen = workLen;
+        if(!workLen) return 0;
+    }
+    return insertState(dfa, hash);
+}
+
+
+/**
+ * @brief
+ *      Adds the instructions reached from an instruction without reading a byte to dfa->work. Only the
+ *      instructions that read a byte, wait for the end of the line or match are kept in a state.
+ *
+ * @param atLineStart
+ *      Boolean value indicating whether INST_LINE_START may go on.
+ *
+ * @param atLineEnd
+ *      Boolean value indicating whether INST_LINE_END may go on, once the end of the line is read.
+ */
+static void addClosure(LazyDfa *dfa, int32_t pc, bool atLineStart, bool atLineEnd){
+    const RegexInst *insts = dfa->program->insts;
+    int32_t top = 0;
+
+    dfa->stack[top++] = pc;
+    while(top){
+        const RegexInst *inst = insts + (pc = dfa->stack[--top]);
+
+        if(dfa->marks[pc] == dfa->mark) continue;
+        dfa->marks[pc] = dfa->mark;
+
+        if(inst->kind == INST_SPLIT) dfa->stack[top++] = inst->alt;
+        if(inst->kind == INST_SPLIT || inst->kind == INST_JUMP || inst->kind == INST_SAVE) dfa->stack[top++] = inst->next;
+        else if(inst->kind == INST_LINE_START ? atLineStart : inst->kind == INST_LINE_END && atLineEnd){
+            dfa->stack[top++] = inst->next;
+        }
+        else if(inst->kind != INST_LINE_START) dfa->work[dfa->workLen++] = pc;
+    }
+}
+
+
+/**
+ * @brief
+ *      Obtains the start state of a DFA.
+ *
+ * @param atLineStart
+ *      Boolean value indicating whether the scan begins at the beginning of the line.
+ */
+static int32_t startDfa(LazyDfa *dfa, bool atLineStart){
+    if(dfa->startStates[atLineStart] >= 0) return dfa->startStates[atLineStart];
+
+    nextMark(dfa->marks, &dfa->mark, dfa->program->instCount);
+    dfa->workLen = 0;
+    addClosure(dfa, dfa->program->start, atLineStart, false);
+    return dfa->startStates[atLineStart] = findState(dfa);
+}
+
+
+/**
+ * @brief
+ *      Builds the transition of a state on a byte class, or on the end of the line (see LazyDfa).
+ *
+ * @return
+ *      Index of the next state.
+ */
+static int32_t stepDfa(LazyDfa *dfa, int32_t state, int symbol){
+    const RegexInst *insts = dfa->program->insts;
+    const int32_t *set = dfa->pool + dfa->setOffsets[state];
+    bool lineEnd = symbol >= dfa->regex->classCount, emptyLine = symbol == dfa->regex->classCount + 1;
+    unsigned char byte = dfa->regex->classByte[lineEnd ? 0 : symbol];
+    unsigned generation = dfa->generation;
+
+    nextMark(dfa->marks, &dfa->mark, dfa->program->instCount);
+    dfa->workLen = 0;
+    for(int32_t i = 0; i < dfa->setLens[state]; i++){
+        const RegexInst *inst = insts + set[i];
+        if(lineEnd ? inst->kind == INST_LINE_END : inst->kind == INST_BYTE && hasByte(dfa->regex->sets[inst->arg], byte)){
+            addClosure(dfa, inst->next, emptyLine, lineEnd);
+        }
+    }
+    if(dfa->unanchored && !lineEnd) addClosure(dfa, dfa->program->start, false, false);
+
+    int32_t found = findState(dfa);
+    if(generation == dfa->generation) dfa->next[(size_t)state * dfa->stride + symbol] = found;
+    return found;
+}
+
+
+static inline int32_t nextState(LazyDfa *dfa, int32_t state, int symbol){
+    int32_t found = dfa->next[(size_t)state * dfa->stride + symbol];
+    return found >= 0 ? found : stepDfa(dfa, state, symbol);
+}
+
+
+/**
+ * @brief
+ *      Obtains the state of a DFA once the end of the line is read.
+ *
+ * @param emptyLine
+ *      Boolean value indicating whether the line is empty, so its end is its beginning as well.
+ */
+static int32_t endDfa(LazyDfa *dfa, int32_t state, bool emptyLine){
+    return nextState(dfa, state, dfa->regex->classCount + emptyLine);
+}
+
+
+/**
+ * @brief
+ *      Allocates an empty DFA of a program.
+ *
+ * @return
+ *      False if it couldn't be allocated.
+ */
+static bool initDfa(LazyDfa *dfa, const Regex *regex, const RegexProgram *program, bool unanchored){
+    int32_t instCount = program->instCount, buckets = 1;
+
+    while(buckets < 2 * REGEX_CACHE_STATES) buckets *= 2;
+
+    dfa->regex = regex;
+    dfa->program = program;
+    dfa->unanchored = unanchored;
+    dfa->stride = regex->classCount + 2;
+    dfa->poolCapacity = REGEX_CACHE_STATES * 16 > 2 * instCount ? REGEX_CACHE_STATES * 16 : 2 * instCount;
+    dfa->bucketMask = buckets - 1;
+    dfa->mark = 0;
+    dfa->generation = 0;
+
+    dfa->next = malloc((size_t)REGEX_CACHE_STATES * dfa->stride * sizeof(int32_t));
+    dfa->setOffsets = malloc(REGEX_CACHE_STATES * sizeof(int32_t));
+    dfa->setLens = malloc(REGEX_CACHE_STATES * sizeof(int32_t));
+    dfa->accepting = malloc(REGEX_CACHE_STATES * sizeof(bool));
+    dfa->pool = malloc(dfa->poolCapacity * sizeof(int32_t));
+    dfa->buckets = malloc(buckets * sizeof(int32_t));
+    dfa->stack = malloc((2 * instCount + 1) * sizeof(int32_t));
+    dfa->work = malloc(instCount * sizeof(int32_t));
+    dfa->marks = calloc(instCount, sizeof(uint32_t));
+
+    if(!dfa->next || !dfa->setOffsets || !dfa->setLens || !dfa->accepting || !dfa->pool || !dfa->buckets ||
+        !dfa->stack || !dfa->work || !dfa->marks) return false;
+
+    resetDfa(dfa);
+    return true;
+}
+
+
+static void freeDfa(LazyDfa *dfa){
+    free(dfa->next);
+    free(dfa->setOffsets);
+    free(dfa->setLens);
+    free(dfa->accepting);
+    free(dfa->pool);
+    free(dfa->buckets);
+    free(dfa->stack);
+    free(dfa->work);
+    free(dfa->marks);
+}
+
+
+/**
+ * @brief
+ *      Allocates the DFAs (and the thread lists of the groups) a context uses to match a regex.
+ *
+ * @param regex
+ *      Compiled regex, which must outlive the cache.
+ *
+ * @return
+ *      New cache, or NULL if it couldn't be allocated.
+ */
+RegexCache *newRegexCache(const Regex *regex){
+    RegexCache *cache = calloc(1, sizeof(RegexCache));
+    int32_t instCount = regex->forward.instCount;
+
+    if(!cache) return NULL;
+
+    bool allocated = initDfa(&cache->reverse, regex, &regex->reverse, true) &&
+        initDfa(&cache->forward, regex, &regex->forward, false);
+
+    if(allocated && regex->groupsUsed){
+        for(int list = 0; list < 2; list++){
+            cache->threads[list] = malloc(instCount * sizeof(int32_t));
+            cache->groups[list] = malloc((size_t)instCount * GROUP_SLOTS * sizeof(size_t));
+            allocated = allocated && cache->threads[list] && cache->groups[list];
+        }
+        cache->stack = malloc((2 * instCount + 1) * sizeof(int32_t));
+        cache->stackSlots = malloc((2 * instCount + 1) * sizeof(size_t));
+        cache->marks = calloc(instCount, sizeof(uint32_t));
+        allocated = allocated && cache->stack && cache->stackSlots && cache->marks;
+    }
+
+    if(!allocated){
+        freeRegexCache(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+
+/**
+ * @brief
+ *      Frees a cache made by newRegexCache().
+ *
+ * @param cache
+ *      Cache to be freed, or NULL.
+ */
+void freeRegexCache(RegexCache *cache){
+    if(!cache) return;
+
+    freeDfa(&cache->reverse);
+    freeDfa(&cache->forward);
+    free(cache->starts);
+    free(cache->checkStates);
+    for(int list = 0; list < 2; list++){
+        free(cache->threads[list]);
+        free(cache->groups[list]);
+    }
+    free(cache->stack);
+    free(cache->stackSlots);
+    free(cache->marks);
+    free(cache);
+}
+
+
+/**
+ * @brief
+ *      Marks every offset of a line where a match of the regex begins, in a single backward pass of the reverse
+ *      DFA from the end of the line.
+ *
+ * @param cache
+ *      Cache of the context.
+ *
+ * @param texts
+ *      Line to be searched, without its '\n'.
+ *
+ * @param textsLen
+ *      Number of characters in texts.
+ *
+ * @param from
+ *      Offset before which no match may begin (the first match of the prefix), where the pass stops.
+ *
+ * @param lineStart
+ *      Boolean value indicating whether texts begins the line, rather than continuing texts already printed.
+ *
+ * @return
+ *      False if the bitmap of the offsets couldn't be allocated.
+ */
+bool findRegexStarts(RegexCache *cache, const char *texts, size_t textsLen, size_t from, bool lineStart){
+    LazyDfa *dfa = &cache->reverse;
+    const unsigned char *byteClass = dfa->regex->byteClass;
+    size_t words = (textsLen - from) / 64 + 1;
+
+    if(words > cache->startsCapacity){
+        uint64_t *larger = realloc(cache->starts, words * sizeof(uint64_t));
+        if(!larger) return false;
+        cache->starts = larger;
+
+        int32_t *checkStates = realloc(cache->checkStates, words * sizeof(int32_t));
+        if(!checkStates) return false;
+        cache->checkStates = checkStates;
+        cache->startsCapacity = words;
+    }
+    memset(cache->starts, 0, words * sizeof(uint64_t));
+    cache->startsFrom = from;
+    cache->startsEnd = textsLen;
+    cache->lineStart = lineStart;
+    cache->scanTo = 0;
+
+    int32_t state = startDfa(dfa, true);
+    for(size_t i = textsLen; ; i--){
+        //Read backwards, the beginning of the line is its end.
+        bool accepted = dfa->accepting[state] ||
+            (i == 0 && lineStart && dfa->accepting[endDfa(dfa, state, textsLen == 0)]);
+        if(accepted) cache->starts[(i - from) >> 6] |= 1ULL << ((i - from) & 63);
+
+        if(i == from) break;
+        state = nextState(dfa, state, byteClass[(unsigned char)texts[i - 1]]);
+    }
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Obtains the first offset at or after from where a match begins, among those marked by findRegexStarts().
+ *
+ * @return
+ *      Offset of the match, or SIZE_MAX if no match begins there.
+ */
+size_t nextRegexStart(const RegexCache *cache, size_t from){
+    if(from > cache->startsEnd) return NO_OFFSET;
+
+    size_t bit = from - cache->startsFrom, word = bit >> 6, words = (cache->startsEnd - cache->startsFrom) / 64 + 1;
+    uint64_t bits = cache->starts[word] & (~0ULL << (bit & 63));
+
+    while(!bits){
+        if(++word == words) return NO_OFFSET;
+        bits = cache->starts[word];
+    }
+    return cache->startsFrom + word * 64 + __builtin_ctzll(bits);
+}
+
+
+/**
+ * @brief
+ *      Finds the end of the longest match that begins at an offset, with the forward DFA.
+ *
+ * @note
+ *      Every 64th offset from startsFrom on is a checkpoint where the state of the scan is kept (see RegexCache).
+ *      Once the scan reaches the state the previous scan had at a checkpoint, both read the same texts from the
+ *      same state, so the rest of the scan is that of the previous one and the match ends where it ended (or
+ *      where the scan last accepted, when the previous match ended before the checkpoint). The matches passed
+ *      to the function must begin further and further in the line.
+ *
+ * @param cache
+ *      Cache of the context.
+ *
+ * @param texts
+ *      Line to be searched, without its '\n'.
+ *
+ * @param textsLen
+ *      Number of characters in texts.
+ *
+ * @param start
+ *      Offset where the match begins.
+ *
+ * @return
+ *      Offset right after the match, or SIZE_MAX if no match begins there.
+ */
+size_t longestRegexMatch(RegexCache *cache, const char *texts, size_t textsLen, size_t start){
+    LazyDfa *dfa = &cache->forward;
+    const unsigned char *byteClass = dfa->regex->byteClass;
+    int32_t state = startDfa(dfa, start == 0 && cache->lineStart);
+    unsigned generation = dfa->generation;
+    size_t end = dfa->accepting[state] ? start : NO_OFFSET, pos;
+
+    //State 0 is the empty set, after which nothing can match.
+    for(pos = start; pos < textsLen && state; pos++){
+        state = nextState(dfa, state, byteClass[(unsigned char)texts[pos]]);
+        if(dfa->accepting[state]) end = pos + 1;
+
+        size_t check = pos + 1 - cache->startsFrom;
+        if(check & 63) continue;
+
+        //The states of both scans can only be compared while the DFA keeps the states of the previous scan.
+        int32_t *checkState = cache->checkStates + (check >> 6);
+        if(pos + 1 <= cache->scanTo && *checkState == state && dfa->generation == cache->scanGeneration){
+            if(cache->scanEnd != NO_OFFSET && cache->scanEnd >= pos + 1) end = cache->scanEnd;
+            cache->scanEnd = end;
+            return end;
+        }
+        *checkState = state;
+    }
+    if(pos == textsLen && state && dfa->accepting[endDfa(dfa, state, textsLen == 0 && cache->lineStart)]) end = textsLen;
+
+    //A DFA that was reset during the scan leaves checkpoints of both generations.
+    cache->scanTo = generation == dfa->generation ? pos : 0;
+    cache->scanEnd = end;
+    cache->scanGeneration = dfa->generation;
+    return end;
+}
+
+
+/**
+ * @brief
+ *      Adds a thread of the Pike VM to a thread list, along with the threads reached from it without reading a
+ *      byte. A thread that reaches an instruction first takes it, so the list keeps the order of preference.
+ *
+ * @param groups
+ *      Offsets of the groups of the thread, which are the same once the function returns.
+ *
+ * @param pos
+ *      Offset of the thread in the line.
+ */
+static void addThread(RegexCache *cache, int list, int32_t pc, size_t *groups, size_t pos, size_t textsLen){
+    const RegexInst *insts = cache->forward.regex->forward.insts;
+    int32_t top = 0;
+
+    //Negative entries of the stack restore the slot -entry - 1 to the offset kept beside them.
+    cache->stack[top++] = pc;
+    while(top){
+        pc = cache->stack[--top];
+        if(pc < 0){
+            groups[-pc - 1] = cache->stackSlots[top];
+            continue;
+        }
+        if(cache->marks[pc] == cache->mark) continue;
+        cache->marks[pc] = cache->mark;
+
+        const RegexInst *inst = insts + pc;
+        if(inst->kind == INST_SPLIT){
+            cache->stack[top++] = inst->alt;
+            cache->stack[top++] = inst->next;
+        }
+        else if(inst->kind == INST_SAVE){
+            cache->stackSlots[top] = groups[inst->arg];
+            cache->stack[top++] = -inst->arg - 1;
+            groups[inst->arg] = pos;
+            cache->stack[top++] = inst->next;
+        }
+        else if(inst->kind == INST_JUMP || (inst->kind == INST_LINE_START && pos == 0 && cache->lineStart) ||
+            (inst->kind == INST_LINE_END && pos == textsLen)){
+            cache->stack[top++] = inst->next;
+        }
+        else if(inst->kind == INST_BYTE || inst->kind == INST_MATCH){
+            int32_t thread = cache->threadCounts[list]++;
+            cache->threads[list][thread] = pc;
+            memcpy(cache->groups[list] + (size_t)thread * GROUP_SLOTS, groups, GROUP_SLOTS * sizeof(size_t));
+        }
+    }
+}
+
+
+/**
+ * @brief
+ *      Finds the groups of a match with a Pike VM that only reads the match.
+ *
+ * @note
+ *      Among the ways the regex matches the texts of the match, the groups are taken from the preferred one:
+ *      the earlier alternative of a '|', and the longer run of a repetition.
+ *
+ * @param cache
+ *      Cache of the context, made for a regex whose replacement text uses its groups.
+ *
+ * @param texts
+ *      Line being searched, without its '\n'.
+ *
+ * @param textsLen
+ *      Number of characters in texts.
+ *
+ * @param start
+ *      Offset where the match begins.
+ *
+ * @param end
+ *      Offset right after the match (see longestRegexMatch()).
+ *
+ * @param groups
+ *      Array of 2 * REGEX_GROUPS offsets receiving the beginning and the end of every group, or SIZE_MAX for a
+ *      group that took no part in the match.
+ */
+void regexGroups(RegexCache *cache, const char *texts, size_t textsLen, size_t start, size_t end, size_t *groups){
+    const Regex *regex = cache->forward.regex;
+    const RegexInst *insts = regex->forward.insts;
+    int32_t instCount = regex->forward.instCount;
+    size_t threadGroups[GROUP_SLOTS];
+    int list = 0;
+
+    for(int slot = 0; slot < GROUP_SLOTS; slot++) groups[slot] = NO_OFFSET;
+
+    nextMark(cache->marks, &cache->mark, instCount);
+    cache->threadCounts[list] = 0;
+    addThread(cache, list, regex->forward.start, groups, start, textsLen);
+
+    for(size_t pos = start; pos < end; pos++){
+        unsigned char byte = texts[pos];
+
+        nextMark(cache->marks, &cache->mark, instCount);
+        cache->threadCounts[!list] = 0;
+        for(int32_t t = 0; t < cache->threadCounts[list]; t++){
+            const RegexInst *inst = insts + cache->threads[list][t];
+            if(inst->kind != INST_BYTE || !hasByte(regex->sets[inst->arg], byte)) continue;
+
+            memcpy(threadGroups, cache->groups[list] + (size_t)t * GROUP_SLOTS, sizeof(threadGroups));
+            addThread(cache, !list, inst->next, threadGroups, pos + 1, textsLen);
+        }
+        list = !list;
+    }
+
+    //The first thread that matches at the end is the preferred one.
+    for(int32_t t = 0; t < cache->threadCounts[list]; t++){
+        if(insts[cache->threads[list][t]].kind == INST_MATCH){
+            memcpy(groups, cache->groups[list] + (size_t)t * GROUP_SLOTS, GROUP_SLOTS * sizeof(size_t));
+            break;
+        }
+    }
+    groups[0] = start;
+    groups[1] = end;
+}
@@ -0,0 +1,1196 @@
+/**
+ * @file SearchKernel.c
+ *
+ * @brief
+ *      Substring search kernels that return every match offset in a block in one pass.
+ *
+ * @note
+ *      The vectorized kernels compare the first and the last byte of the pattern against a whole vector of
+ *      candidate positions at once, and only check the remaining bytes of the candidates that pass both
+ *      filters. The kernel is chosen once at runtime through CPUID (AVX2, then SSE2, then scalar).
+ * @note
+ *      Patterns of 1 to FIXED_KERNEL_MAX bytes get kernels of their own, compiled with the pattern length as a
+ *      constant, so the candidate checks fold into a few compares (see patternKernel()).
+ * @note
+ *      The fold kernels search a folded pattern (i flag) whatever the case of the texts, which are folded in the
+ *      registers rather than copied: setting the case bit (0x20) of every byte compared with a folded letter makes
+ *      both of its cases equal to it, so they cost an OR per vector (see foldedPatternKernel()).
+ * @note
+ *      Patterns of TWO_WAY_MIN bytes or more are searched with the Two-Way algorithm instead, driven by a
+ *      Horspool skip table on the last byte of the window. Long patterns then skip most of the texts, and the
+ *      critical factorization keeps the search linear however much the pattern repeats itself. Their tables are
+ *      built once by fr_compile() (see buildPatternTable()).
+ * @note
+ *      The newline kernels count the '\n' of 64 bytes at a time, so the line numbers of the l flag are tracked
+ *      without a call per line (see skipNewlines()).
+ * @note
+ *      The mask kernels find the bytes equal to the first/last byte of a prefix/suffix and the word characters of
+ *      64 bytes at a time, so the words that begin/end with it are found with bit operations rather than a lookup
+ *      per byte (see AffixScanner). SSE2 has no byte shuffle to look the word characters up with, so it gets the
+ *      scalar kernels.
+ */
+#include <pthread.h>
+
+#include "SearchKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define X86_KERNELS
+#endif
+
+static SearchKernel selectedKernel = NULL, selectedFoldKernel = NULL;
+static NewlineKernel selectedNewlineKernel = NULL;
+static CandidateKernel selectedCandidateKernel = NULL, selectedFoldCandidateKernel = NULL;
+static ByteMaskKernel selectedEqualMaskKernel = NULL;
+static WordMaskKernel selectedWordMaskKernel = NULL;
+static pthread_once_t kernelChosen = PTHREAD_ONCE_INIT;
+
+//Kernels of the chosen instruction set for patterns of 1 to FIXED_KERNEL_MAX bytes (index 0 is unused)
+static SearchKernel fixedKernels[FIXED_KERNEL_MAX + 1], foldFixedKernels[FIXED_KERNEL_MAX + 1];
+
+//Bodies of the kernels, inlined into every kernel so a constant pattern length folds into them
+#define KERNEL_BODY static inline __attribute__((always_inline))
+
+
+/**
+ * @brief
+ *      Finds the offsets of all (possibly overlapping) occurrences of pattern in texts with the fastest
+ *      kernel supported by the CPU.
+ *
+ * @param texts
+ *      Block of texts to be searched. It doesn't need to be null-terminated.
+ *
+ * @param textsLen
+ *      Number of characters in texts.
+ *
+ * @param pattern
+ *      Pattern to be searched for.
+ *
+ * @param patternLen
+ *      Number of characters in pattern.
+ *
+ * @param offsets
+ *      Array that receives the offsets of the matches in increasing order.
+ *
+ * @param maxOffsets
+ *      Capacity of offsets. When it is reached, the search stops and can be resumed after the last offset.
+ *
+ * @return
+ *      Number of offsets stored.
+ */
+size_t searchAll(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets){
+    if(!selectedKernel) initSearchKernel();
+    return selectedKernel(texts, textsLen, pattern, patternLen, offsets, maxOffsets);
+}
+
+
+static void chooseSearchKernel(){
+    selectedKernel = selectSearchKernel();
+    selectedFoldKernel = selectFoldKernel(selectedKernel);
+    selectFixedKernels(selectedKernel, false, fixedKernels);
+    selectFixedKernels(selectedKernel, true, foldFixedKernels);
+    selectedNewlineKernel = selectNewlineKernel();
+    selectedCandidateKernel = selectCandidateKernel(selectedKernel, false);
+    selectedFoldCandidateKernel = selectCandidateKernel(selectedKernel, true);
+    selectMaskKernels(&selectedEqualMaskKernel, &selectedWordMaskKernel);
+}
+
+
+/**
+ * @brief
+ *      Chooses the search kernel ahead of time, so threads never race to initialize it in searchAll().
+ *
+ * @note
+ *      Safe to call from several threads at once: the kernel is only chosen by the first call.
+ */
+void initSearchKernel(){
+    pthread_once(&kernelChosen, chooseSearchKernel);
+}
+
+
+/**
+ * @brief
+ *      Chooses the search kernel based on the instruction sets reported by CPUID.
+ *
+ * @return
+ *      Pointer to the chosen search kernel.
+ */
+SearchKernel selectSearchKernel(){
+#ifdef X86_KERNELS
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return searchAllAVX2;
+    if(__builtin_cpu_supports("sse2")) return searchAllSSE2;
+#endif
+    return searchAllScalar;
+}
+
+
+/**
+ * @brief
+ *      Obtains the fold kernel that belongs to the same instruction set as a search kernel.
+ *
+ * @param kernel
+ *      General kernel chosen by selectSearchKernel().
+ *
+ * @return
+ *      Pointer to the fold kernel, which finds a folded pattern whatever the case of the texts.
+ */
+SearchKernel selectFoldKernel(SearchKernel kernel){
+#ifdef X86_KERNELS
+    if(kernel == searchAllAVX2) return searchFoldAVX2;
+    if(kernel == searchAllSSE2) return searchFoldSSE2;
+#endif
+    (void)kernel;
+    return searchFoldScalar;
+}
+
+
+/**
+ * @brief
+ *      Obtains the search kernel for patterns of a given length, specialized for that length when it is short.
+ *
+ * @param patternLen
+ *      Number of characters in the pattern.
+ *
+ * @return
+ *      Pointer to the search kernel, which takes the same arguments as searchAll().
+ */
+SearchKernel patternKernel(size_t patternLen){
+    initSearchKernel();
+    return patternLen >= 1 && patternLen <= FIXED_KERNEL_MAX ? fixedKernels[patternLen] : selectedKernel;
+}
+
+
+/**
+ * @brief
+ *      Obtains the fold kernel for patterns of a given length, as patternKernel() does.
+ *
+ * @param patternLen
+ *      Number of characters in the pattern, which must be folded (see foldText()).
+ *
+ * @return
+ *      Pointer to the fold kernel, which takes the same arguments as searchAll().
+ */
+SearchKernel foldedPatternKernel(size_t patternLen){
+    initSearchKernel();
+    return patternLen >= 1 && patternLen <= FIXED_KERNEL_MAX ? foldFixedKernels[patternLen] : selectedFoldKernel;
+}
+
+
+/**
+ * @brief
+ *      Names the search kernel chosen for this CPU.
+ *
+ * @return
+ *      "avx2", "sse2" or "scalar".
+ */
+const char *searchKernelName(){
+    SearchKernel kernel = selectSearchKernel();
+#ifdef X86_KERNELS
+    if(kernel == searchAllAVX2) return "avx2";
+    if(kernel == searchAllSSE2) return "sse2";
+#endif
+    return kernel == searchAllScalar ? "scalar" : "unknown";
+}
+
+
+/**
+ * @brief
+ *      Scalar search kernel. Candidates are found with memchr on the first byte of the pattern, or byte by byte
+ *      when the pattern is folded, since memchr only finds one case of a letter.
+ *
+ * @note
+ *      See searchAll() for the other parameters and the return value.
+ *
+ * @param fold
+ *      Boolean value indicating whether the pattern is folded and matches the texts whatever their case.
+ */
+KERNEL_BODY size_t searchScalar(const char *texts, size_t textsLen, const char *pattern, size_t patternLen,
+    size_t *offsets, size_t maxOffsets, bool fold){
+    if(!patternLen || patternLen > textsLen) return 0;
+
+    const char *candidate = texts, *end = texts + textsLen - patternLen + 1;
+    size_t count = 0;
+
+    if(fold){
+        for(; candidate < end && count < maxOffsets; candidate++){
+            if(foldByte(candidate[0]) == (unsigned char)pattern[0] && equalPattern(candidate + 1, pattern + 1, patternLen - 1, true))
+                offsets[count++] = candidate - texts;
+        }
+        return count;
+    }
+
+    while(count < maxOffsets && (candidate = memchr(candidate, pattern[0], end - candidate))){
+        if(candidate[patternLen - 1] == pattern[patternLen - 1] && !memcmp(candidate + 1, pattern + 1, patternLen - 1))
+            offsets[count++] = candidate - texts;
+        candidate++;
+    }
+    return count;
+}
+
+size_t searchAllScalar(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets){
+    return searchScalar(texts, textsLen, pattern, patternLen, offsets, maxOffsets, false);
+}
+
+size_t searchFoldScalar(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets){
+    return searchScalar(texts, textsLen, pattern, patternLen, offsets, maxOffsets, true);
+}
+
+
+#ifdef X86_KERNELS
+/**
+ * @brief
+ *      Checks the candidates marked in mask and stores the offsets of the true matches.
+ *
+ * @param mask
+ *      Bit i is set when texts[base + i] and texts[base + i + patternLen - 1] match the first and last byte
+ *      of the pattern.
+ *
+ * @return
+ *      Updated number of offsets stored.
+ */
+KERNEL_BODY size_t checkCandidates(unsigned int mask, size_t base, const char *texts, const char *pattern,
+    size_t patternLen, size_t *offsets, size_t count, size_t maxOffsets, bool fold){
+    while(mask && count < maxOffsets){
+        size_t offset = base + __builtin_ctz(mask);
+        if(patternLen < 3 || equalPattern(texts + offset + 1, pattern + 1, patternLen - 2, fold)) offsets[count++] = offset;
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+
+/**
+ * @brief
+ *      Searches the texts that are too short for a whole vector with the scalar kernel.
+ *
+ * @return
+ *      Updated number of offsets stored.
+ */
+KERNEL_BODY size_t searchTail(size_t pos, const char *texts, size_t textsLen, const char *pattern, size_t patternLen,
+    size_t *offsets, size_t count, size_t maxOffsets, bool fold){
+    size_t found = searchScalar(texts + pos, textsLen - pos, pattern, patternLen, offsets + count, maxOffsets - count, fold);
+    for(size_t i = count; i < count + found; i++) offsets[i] += pos;
+    return count + found;
+}
+
+
+/**
+ * @brief
+ *      SSE2 search kernel that filters 16 candidate positions per iteration.
+ *
+ * @note
+ *      See searchAll() for the parameters and the return value.
+ */
+__attribute__((target("sse2"))) KERNEL_BODY
+size_t searchSSE2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets, bool fold){
+    if(!patternLen || patternLen > textsLen) return 0;
+
+    const __m128i first = _mm_set1_epi8(pattern[0]), last = _mm_set1_epi8(pattern[patternLen - 1]),
+        firstCase = _mm_set1_epi8(fold ? foldBit(pattern[0]) : 0),
+        lastCase = _mm_set1_epi8(fold ? foldBit(pattern[patternLen - 1]) : 0);
+    size_t pos = 0, count = 0;
+
+    for(; pos + patternLen - 1 + 16 <= textsLen && count < maxOffsets; pos += 16){
+        __m128i firstBlock = _mm_or_si128(_mm_loadu_si128((const __m128i *)(texts + pos)), firstCase),
+                lastBlock = _mm_or_si128(_mm_loadu_si128((const __m128i *)(texts + pos + patternLen - 1)), lastCase);
+        unsigned int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstBlock, first), _mm_cmpeq_epi8(lastBlock, last)));
+        count = checkCandidates(mask, pos, texts, pattern, patternLen, offsets, count, maxOffsets, fold);
+    }
+
+    //The last positions are filtered by a vector that overlaps the positions already done, rather than one by one.
+    size_t end = textsLen - (patternLen - 1);
+    if(pos < end && end >= 16 && count < maxOffsets){
+        __m128i firstBlock = _mm_or_si128(_mm_loadu_si128((const __m128i *)(texts + end - 16)), firstCase),
+                lastBlock = _mm_or_si128(_mm_loadu_si128((const __m128i *)(texts + end - 16 + patternLen - 1)), lastCase);
+        unsigned int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstBlock, first), _mm_cmpeq_epi8(lastBlock, last)));
+        return checkCandidates(mask >> (pos - (end - 16)), pos, texts, pattern, patternLen, offsets, count, maxOffsets, fold);
+    }
+
+    if(count == maxOffsets) return count;
+    return searchTail(pos, texts, textsLen, pattern, patternLen, offsets, count, maxOffsets, fold);
+}
+
+
+/**
+ * @brief
+ *      AVX2 search kernel that filters 32 candidate positions per iteration.
+ *
+ * @note
+ *      See searchAll() for the parameters and the return value.
+ */
+__attribute__((target("avx2"))) KERNEL_BODY
+size_t searchAVX2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets, bool fold){
+    if(!patternLen || patternLen > textsLen) return 0;
+
+    const __m256i first = _mm256_set1_epi8(pattern[0]), last = _mm256_set1_epi8(pattern[patternLen - 1]),
+        firstCase = _mm256_set1_epi8(fold ? foldBit(pattern[0]) : 0),
+        lastCase = _mm256_set1_epi8(fold ? foldBit(pattern[patternLen - 1]) : 0);
+    size_t pos = 0, count = 0;
+
+    //Two vectors per iteration while there is room, so rare patterns mostly cost two loads and a test.
+    for(; pos + patternLen - 1 + 64 <= textsLen && count < maxOffsets; pos += 64){
+        __m256i matchLow = _mm256_and_si256(
+                    _mm256_cmpeq_epi8(_mm256_or_si256(_mm256_loadu_si256((const __m256i *)(texts + pos)), firstCase), first),
+                    _mm256_cmpeq_epi8(_mm256_or_si256(_mm256_loadu_si256((const __m256i *)(texts + pos + patternLen - 1)), lastCase), last)),
+                matchHigh = _mm256_and_si256(
+                    _mm256_cmpeq_epi8(_mm256_or_si256(_mm256_loadu_si256((const __m256i *)(texts + pos + 32)), firstCase), first),
+                    _mm256_cmpeq_epi8(_mm256_or_si256(_mm256_loadu_si256((const __m256i *)(texts + pos + 32 + patternLen - 1)), lastCase), last));
+        if(_mm256_testz_si256(_mm256_or_si256(matchLow, matchHigh), _mm256_or_si256(matchLow, matchHigh))) continue;
+
+        count = checkCandidates(_mm256_movemask_epi8(matchLow), pos, texts, pattern, patternLen, offsets, count, maxOffsets, fold);
+        count = checkCandidates(_mm256_movemask_epi8(matchHigh), pos + 32, texts, pattern, patternLen, offsets, count, maxOffsets, fold);
+    }
+
+    for(; pos + patternLen - 1 + 32 <= textsLen && count < maxOffsets; pos += 32){
+        __m256i firstBlock = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(texts + pos)), firstCase),
+                lastBlock = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(texts + pos + patternLen - 1)), lastCase);
+        unsigned int mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(firstBlock, first), _mm256_cmpeq_epi8(lastBlock, last)));
+        count = checkCandidates(mask, pos, texts, pattern, patternLen, offsets, count, maxOffsets, fold);
+    }
+
+    //The last positions are filtered by a vector that overlaps the positions already done, rather than one by one.
+    size_t end = textsLen - (patternLen - 1);
+    if(pos < end && end >= 32 && count < maxOffsets){
+        __m256i firstBlock = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(texts + end - 32)), firstCase),
+                lastBlock = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(texts + end - 32 + patternLen - 1)), lastCase);
+        unsigned int mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(firstBlock, first), _mm256_cmpeq_epi8(lastBlock, last)));
+        return checkCandidates(mask >> (pos - (end - 32)), pos, texts, pattern, patternLen, offsets, count, maxOffsets, fold);
+    }
+
+    if(count == maxOffsets) return count;
+    return searchTail(pos, texts, textsLen, pattern, patternLen, offsets, count, maxOffsets, fold);
+}
+
+__attribute__((target("sse2")))
+size_t searchAllSSE2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets){
+    return searchSSE2(texts, textsLen, pattern, patternLen, offsets, maxOffsets, false);
+}
+
+__attribute__((target("avx2")))
+size_t searchAllAVX2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets){
+    return searchAVX2(texts, textsLen, pattern, patternLen, offsets, maxOffsets, false);
+}
+
+__attribute__((target("sse2")))
+size_t searchFoldSSE2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets){
+    return searchSSE2(texts, textsLen, pattern, patternLen, offsets, maxOffsets, true);
+}
+
+__attribute__((target("avx2")))
+size_t searchFoldAVX2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, size_t *offsets,
+    size_t maxOffsets){
+    return searchAVX2(texts, textsLen, pattern, patternLen, offsets, maxOffsets, true);
+}
+#endif
+
+
+/*
+FIXED_KERNELS defines the kernels of an instruction set for patterns of 1 to 4 bytes (FIXED_KERNEL_MAX), named
+after name. Each one only passes a constant pattern length (and fold) to the body of the instruction set.
+*/
+#define FIXED_KERNEL(name, body, attributes, fold, length) \
+    attributes static size_t name##length(const char *texts, size_t textsLen, const char *pattern, \
+        size_t patternLen, size_t *offsets, size_t maxOffsets){ \
+        (void)patternLen; \
+        return body(texts, textsLen, pattern, length, offsets, maxOffsets, fold); \
+    }
+#define FIXED_KERNELS(name, body, attributes, fold) \
+    FIXED_KERNEL(name, body, attributes, fold, 1) FIXED_KERNEL(name, body, attributes, fold, 2) \
+    FIXED_KERNEL(name, body, attributes, fold, 3) FIXED_KERNEL(name, body, attributes, fold, 4)
+
+FIXED_KERNELS(searchScalar, searchScalar, , false)
+FIXED_KERNELS(searchFoldScalar, searchScalar, , true)
+#ifdef X86_KERNELS
+FIXED_KERNELS(searchSSE2, searchSSE2, __attribute__((target("sse2"))), false)
+FIXED_KERNELS(searchFoldSSE2, searchSSE2, __attribute__((target("sse2"))), true)
+FIXED_KERNELS(searchAVX2, searchAVX2, __attribute__((target("avx2"))), false)
+FIXED_KERNELS(searchFoldAVX2, searchAVX2, __attribute__((target("avx2"))), true)
+#endif
+
+
+/**
+ * @brief
+ *      Fills the kernels for patterns of 1 to FIXED_KERNEL_MAX bytes that belong to the same instruction set as
+ *      a general kernel.
+ *
+ * @param kernel
+ *      General kernel chosen by selectSearchKernel().
+ *
+ * @param fold
+ *      Boolean value indicating whether the kernels are the fold kernels.
+ *
+ * @param kernels
+ *      Array of FIXED_KERNEL_MAX + 1 kernels, indexed by the pattern length.
+ */
+void selectFixedKernels(SearchKernel kernel, bool fold, SearchKernel *kernels){
+    SearchKernel scalar[] = {NULL, searchScalar1, searchScalar2, searchScalar3, searchScalar4},
+        foldScalar[] = {NULL, searchFoldScalar1, searchFoldScalar2, searchFoldScalar3, searchFoldScalar4},
+        *chosen = fold ? foldScalar : scalar;
+#ifdef X86_KERNELS
+    SearchKernel sse2[] = {NULL, searchSSE21, searchSSE22, searchSSE23, searchSSE24},
+        foldSSE2[] = {NULL, searchFoldSSE21, searchFoldSSE22, searchFoldSSE23, searchFoldSSE24},
+        avx2[] = {NULL, searchAVX21, searchAVX22, searchAVX23, searchAVX24},
+        foldAVX2[] = {NULL, searchFoldAVX21, searchFoldAVX22, searchFoldAVX23, searchFoldAVX24};
+    if(kernel == searchAllAVX2) chosen = fold ? foldAVX2 : avx2;
+    else if(kernel == searchAllSSE2) chosen = fold ? foldSSE2 : sse2;
+#endif
+    memcpy(kernels, chosen, sizeof(scalar));
+}
+
+
+/**
+ * @brief
+ *      Obtains the candidate kernel that belongs to the same instruction set as a general kernel.
+ *
+ * @param kernel
+ *      General kernel chosen by selectSearchKernel().
+ *
+ * @param fold
+ *      Boolean value indicating whether the candidate kernel is for folded patterns.
+ *
+ * @return
+ *      Pointer to the candidate kernel.
+ */
+CandidateKernel selectCandidateKernel(SearchKernel kernel, bool fold){
+#ifdef X86_KERNELS
+    if(kernel == searchAllAVX2) return fold ? findFoldCandidateAVX2 : findCandidateAVX2;
+    if(kernel == searchAllSSE2) return fold ? findFoldCandidateSSE2 : findCandidateSSE2;
+#endif
+    (void)kernel;
+    return fold ? findFoldCandidateScalar : findCandidateScalar;
+}
+
+
+/**
+ * @brief
+ *      Scalar candidate kernel. Windows are found with memchr on the first byte of the pattern, or byte by byte
+ *      when the pattern is folded.
+ *
+ * @param texts
+ *      Block of texts to be searched, starting at the first window.
+ *
+ * @param textsLen
+ *      Number of characters in texts.
+ *
+ * @param pattern
+ *      Pattern of at least 1 byte.
+ *
+ * @param patternLen
+ *      Number of characters in pattern.
+ *
+ * @param fold
+ *      Boolean value indicating whether the pattern is folded and matches the texts whatever their case.
+ *
+ * @return
+ *      Offset of the first window whose first and last bytes match the pattern, or textsLen if there is none.
+ */
+KERNEL_BODY size_t candidateScalar(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, bool fold){
+    if(patternLen > textsLen) return textsLen;
+
+    const char *candidate = texts, *end = texts + textsLen - patternLen + 1;
+    if(fold){
+        for(; candidate < end; candidate++){
+            if(foldByte(candidate[0]) == (unsigned char)pattern[0] && foldByte(candidate[patternLen - 1]) == (unsigned char)pattern[patternLen - 1])
+                return candidate - texts;
+        }
+        return textsLen;
+    }
+
+    while((candidate = memchr(candidate, pattern[0], end - candidate))){
+        if(candidate[patternLen - 1] == pattern[patternLen - 1]) return candidate - texts;
+        candidate++;
+    }
+    return textsLen;
+}
+
+size_t findCandidateScalar(const char *texts, size_t textsLen, const char *pattern, size_t patternLen){
+    return candidateScalar(texts, textsLen, pattern, patternLen, false);
+}
+
+size_t findFoldCandidateScalar(const char *texts, size_t textsLen, const char *pattern, size_t patternLen){
+    return candidateScalar(texts, textsLen, pattern, patternLen, true);
+}
+
+
+#ifdef X86_KERNELS
+/**
+ * @brief
+ *      SSE2 candidate kernel that filters 16 windows per iteration.
+ *
+ * @note
+ *      See candidateScalar() for the parameters and the return value.
+ */
+__attribute__((target("sse2"))) KERNEL_BODY
+size_t candidateSSE2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, bool fold){
+    const __m128i first = _mm_set1_epi8(pattern[0]), last = _mm_set1_epi8(pattern[patternLen - 1]),
+        firstCase = _mm_set1_epi8(fold ? foldBit(pattern[0]) : 0),
+        lastCase = _mm_set1_epi8(fold ? foldBit(pattern[patternLen - 1]) : 0);
+    size_t pos = 0;
+
+    for(; pos + patternLen - 1 + 16 <= textsLen; pos += 16){
+        __m128i firstBlock = _mm_or_si128(_mm_loadu_si128((const __m128i *)(texts + pos)), firstCase),
+                lastBlock = _mm_or_si128(_mm_loadu_si128((const __m128i *)(texts + pos + patternLen - 1)), lastCase);
+        unsigned int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstBlock, first), _mm_cmpeq_epi8(lastBlock, last)));
+        if(mask) return pos + __builtin_ctz(mask);
+    }
+    return pos + candidateScalar(texts + pos, textsLen - pos, pattern, patternLen, fold);
+}
+
+
+/**
+ * @brief
+ *      AVX2 candidate kernel that filters 32 windows per iteration.
+ *
+ * @note
+ *      See candidateScalar() for the parameters and the return value.
+ */
+__attribute__((target("avx2"))) KERNEL_BODY
+size_t candidateAVX2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen, bool fold){
+    const __m256i first = _mm256_set1_epi8(pattern[0]), last = _mm256_set1_epi8(pattern[patternLen - 1]),
+        firstCase = _mm256_set1_epi8(fold ? foldBit(pattern[0]) : 0),
+        lastCase = _mm256_set1_epi8(fold ? foldBit(pattern[patternLen - 1]) : 0);
+    size_t pos = 0;
+
+    for(; pos + patternLen - 1 + 32 <= textsLen; pos += 32){
+        __m256i firstBlock = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(texts + pos)), firstCase),
+                lastBlock = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(texts + pos + patternLen - 1)), lastCase);
+        unsigned int mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(firstBlock, first), _mm256_cmpeq_epi8(lastBlock, last)));
+        if(mask) return pos + __builtin_ctz(mask);
+    }
+    return pos + candidateScalar(texts + pos, textsLen - pos, pattern, patternLen, fold);
+}
+
+__attribute__((target("sse2")))
+size_t findCandidateSSE2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen){
+    return candidateSSE2(texts, textsLen, pattern, patternLen, false);
+}
+
+__attribute__((target("avx2")))
+size_t findCandidateAVX2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen){
+    return candidateAVX2(texts, textsLen, pattern, patternLen, false);
+}
+
+__attribute__((target("sse2")))
+size_t findFoldCandidateSSE2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen){
+    return candidateSSE2(texts, textsLen, pattern, patternLen, true);
+}
+
+__attribute__((target("avx2")))
+size_t findFoldCandidateAVX2(const char *texts, size_t textsLen, const char *pattern, size_t patternLen){
+    return candidateAVX2(texts, textsLen, pattern, patternLen, true);
+}
+#endif
+
+
+/**
+ * @brief
+ *      Finds the maximal suffix of a pattern for one of the two orderings of the bytes.
+ *
+ * @param pattern
+ *      Pattern of at least 2 bytes.
+ *
+ * @param patternLen
+ *      Number of characters in pattern.
+ *
+ * @param reverse
+ *      Boolean value indicating whether the bytes are ordered the other way round.
+ *
+ * @param period
+ *      Pointer that is set to the period of the maximal suffix.
+ *
+ * @return
+ *      Offset of the last byte before the maximal suffix, or SIZE_MAX when it is the whole pattern.
+ */
+static size_t maximalSuffix(const unsigned char *pattern, size_t patternLen, bool reverse, size_t *period){
+    size_t suffix = SIZE_MAX, j = 0, k = 1, p = 1;
+
+    //suffix + k wraps around to k - 1 while suffix is SIZE_MAX.
+    while(j + k < patternLen){
+        unsigned char a = pattern[j + k], b = pattern[suffix + k];
+        if(reverse ? a > b : a < b){
+            j += k;
+            k = 1;
+            p = j - suffix;
+        }
+        else if(a == b){
+            if(k != p) k++;
+            else{
+                j += p;
+                k = 1;
+            }
+        }
+        else{
+            suffix = j++;
+            k = p = 1;
+        }
+    }
+    *period = p;
+    return suffix;
+}
+
+
+/**
+ * @brief
+ *      Builds the table of the Two-Way search of a long pattern.
+ *
+ * @note
+ *      The pattern is split where the period of its right half is as long as possible (its critical
+ *      factorization, the shorter of the two maximal suffixes). The right half is then compared from left to
+ *      right and the left half from right to left (see searchTwoWay()).
+ *
+ * @param pattern
+ *      Pattern of at least 2 bytes.
+ *
+ * @param patternLen
+ *      Number of characters in pattern.
+ *
+ * @param fold
+ *      Boolean value indicating whether the pattern is folded and matches the texts whatever their case.
+ *
+ * @param table
+ *      PatternTable to be built.
+ */
+void buildPatternTable(const char *pattern, size_t patternLen, bool fold, PatternTable *table){
+    const unsigned char *bytes = (const unsigned char *)pattern;
+    size_t period, reversePeriod, suffix = maximalSuffix(bytes, patternLen, false, &period),
+        reverseSuffix = maximalSuffix(bytes, patternLen, true, &reversePeriod);
+
+    if(reverseSuffix + 1 >= suffix + 1){
+        suffix = reverseSuffix;
+        period = reversePeriod;
+    }
+    table->suffix = suffix + 1;
+
+    //The left half repeats within the right half only when the whole pattern has that period.
+    table->periodic = !memcmp(pattern, pattern + period, table->suffix);
+    if(table->periodic) table->period = period;
+    else table->period = (table->suffix > patternLen - table->suffix ? table->suffix : patternLen - table->suffix) + 1;
+
+    for(int c = 0; c <= UCHAR_MAX; c++) table->shift[c] = patternLen;
+    for(size_t i = 0; i < patternLen; i++){
+        table->shift[bytes[i]] = patternLen - i - 1;
+        if(fold) table->shift[bytes[i] ^ foldBit(bytes[i])] = patternLen - i - 1;
+    }
+    table->folded = fold;
+}
+
+
+//Byte of the texts as it is compared with a pattern, which is folded when fold is set
+KERNEL_BODY unsigned char textByte(unsigned char c, bool fold){
+    return fold ? foldByte(c) : c;
+}
+
+
+/**
+ * @brief
+ *      Body of searchTwoWay(), compiled once for the folded patterns and once for the others.
+ */
+KERNEL_BODY size_t twoWay(const char *texts, size_t textsLen, const char *pattern, size_t patternLen,
+    const PatternTable *table, size_t *offsets, size_t maxOffsets, bool fold){
+    const unsigned char *window = (const unsigned char *)texts, *bytes = (const unsigned char *)pattern;
+    size_t suffix = table->suffix, period = table->period, memory = 0, count = 0, j = 0;
+    CandidateKernel findCandidate = fold ? selectedFoldCandidateKernel : selectedCandidateKernel;
+
+    if(!patternLen || patternLen > textsLen) return 0;
+
+    while(j <= textsLen - patternLen && count < maxOffsets){
+        size_t shift = table->shift[window[j + patternLen - 1]];
+        if(shift){
+            //A periodic pattern can't match before the byte that broke its period.
+            if(memory && shift < period) shift = patternLen - period;
+            memory = 0;
+            j += shift;
+            if(j <= textsLen - patternLen) j += findCandidate(texts + j, textsLen - j, pattern, patternLen);
+            continue;
+        }
+
+        size_t i = suffix > memory ? suffix : memory;
+        while(i < patternLen - 1 && bytes[i] == textByte(window[i + j], fold)) i++;
+        if(i < patternLen - 1){
+            j += i - suffix + 1;
+            memory = 0;
+            continue;
+        }
+
+        //The right half matches, so the left half is compared from right to left.
+        size_t left = table->periodic ? memory : 0;
+        i = suffix;
+        while(i > left && bytes[i - 1] == textByte(window[i - 1 + j], fold)) i--;
+        if(i <= left) offsets[count++] = j;
+
+        j += period;
+        memory = table->periodic ? patternLen - period : 0;
+    }
+    return count;
+}
+
+
+/**
+ * @brief
+ *      Two-Way search kernel for the long patterns of buildPatternTable().
+ *
+ * @note
+ *      The window first moves by the skip table of its last byte, so a long pattern mostly skips its length
+ *      in one step. A window whose last byte matches is compared right half first. In a periodic pattern,
+ *      memory remembers how much of the left side of the window is already known to match, so no byte is
+ *      compared twice and the search stays linear.
+ * @note
+ *      See searchAll() for the other parameters and the return value.
+ *
+ * @param table
+ *      PatternTable of the pattern. A folded table matches the texts whatever their case.
+ */
+size_t searchTwoWay(const char *texts, size_t textsLen, const char *pattern, size_t patternLen,
+    const PatternTable *table, size_t *offsets, size_t maxOffsets){
+    if(table->folded) return twoWay(texts, textsLen, pattern, patternLen, table, offsets, maxOffsets, true);
+    return twoWay(texts, textsLen, pattern, patternLen, table, offsets, maxOffsets, false);
+}
+
+
+/**
+ * @brief
+ *      Prepares a MatchCursor to hand out the matches of pattern in texts.
+ *
+ * @param matches
+ *      MatchCursor to be prepared.
+ *
+ * @param texts
+ *      Block of texts to be searched.
+ *
+ * @param textsLen
+ *      Number of characters in texts.
+ *
+ * @param pattern
+ *      Pattern to be searched for.
+ *
+ * @param patternLen
+ *      Number of characters in pattern.
+ *
+ * @param kernel
+ *      Search kernel for the pattern (see patternKernel()).
+ *
+ * @param table
+ *      PatternTable of the pattern, which is only used when the pattern has TWO_WAY_MIN bytes or more.
+ */
+void initMatchCursor(MatchCursor *matches, const char *texts, size_t textsLen, const char *pattern, size_t patternLen,
+    SearchKernel kernel, const PatternTable *table){
+    matches->kernel = kernel;
+    matches->table = patternLen >= TWO_WAY_MIN ? table : NULL;
+    matches->texts = texts;
+    matches->textsLen = textsLen;
+    matches->pattern = pattern;
+    matches->patternLen = patternLen;
+    matches->count = matches->next = matches->searchFrom = 0;
+}
+
+
+/**
+ * @brief
+ *      Obtains the first match that starts at or after from.
+ *
+ * @param matches
+ *      MatchCursor prepared by initMatchCursor().
+ *
+ * @param from
+ *      Offset where the search continues. It must never decrease between calls.
+ *
+ * @return
+ *      Pointer to the match, or NULL if there are no more matches.
+ */
+const char *nextMatch(MatchCursor *matches, size_t from){
+    while(true){
+        while(matches->next < matches->count){
+            size_t offset = matches->offsets[matches->next];
+            if(offset >= from) return matches->texts + offset;
+            matches->next++;
+        }
+
+        size_t start = from > matches->searchFrom ? from : matches->searchFrom;
+        if(start + matches->patternLen > matches->textsLen) return NULL;
+
+        if(matches->table)
+            matches->count = searchTwoWay(matches->texts + start, matches->textsLen - start, matches->pattern,
+                matches->patternLen, matches->table, matches->offsets, MATCH_BATCH);
+        else
+            matches->count = matches->kernel(matches->texts + start, matches->textsLen - start, matches->pattern,
+                matches->patternLen, matches->offsets, MATCH_BATCH);
+        if(!matches->count) return NULL;
+
+        for(size_t i = 0; i < matches->count; i++) matches->offsets[i] += start;
+        matches->next = 0;
+        matches->searchFrom = matches->count == MATCH_BATCH ? matches->offsets[MATCH_BATCH - 1] + 1 : matches->textsLen;
+    }
+}
+
+
+/**
+ * @brief
+ *      Skips a number of '\n' in a block with the fastest newline kernel supported by the CPU.
+ *
+ * @param texts
+ *      Block of texts to be scanned.
+ *
+ * @param textsLen
+ *      Number of characters in texts.
+ *
+ * @param lines
+ *      Pointer to the number of '\n' to be skipped, which is decreased by the number of '\n' skipped.
+ *
+ * @return
+ *      Offset right after the last '\n' skipped once *lines reaches 0, otherwise textsLen.
+ */
+size_t skipNewlines(const char *texts, size_t textsLen, long long *lines){
+    if(!selectedNewlineKernel) initSearchKernel();
+    return selectedNewlineKernel(texts, textsLen, lines);
+}
+
+
+/**
+ * @brief
+ *      Chooses the newline kernel based on the instruction sets reported by CPUID.
+ *
+ * @return
+ *      Pointer to the chosen newline kernel.
+ */
+NewlineKernel selectNewlineKernel(){
+#ifdef X86_KERNELS
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) return skipNewlinesAVX2;
+    if(__builtin_cpu_supports("sse2")) return skipNewlinesSSE2;
+#endif
+    return skipNewlinesScalar;
+}
+
+
+/**
+ * @brief
+ *      Scalar newline kernel, which finds each '\n' with memchr.
+ *
+ * @note
+ *      See skipNewlines() for the parameters and the return value.
+ */
+size_t skipNewlinesScalar(const char *texts, size_t textsLen, long long *lines){
+    const char *pos = texts, *end = texts + textsLen;
+
+    if(*lines <= 0) return 0;
+    while(*lines > 0 && (pos = memchr(pos, '\n', end - pos))){
+        pos++;
+        if(!--*lines) return pos - texts;
+    }
+    return textsLen;
+}
+
+
+#ifdef X86_KERNELS
+/**
+ * @brief
+ *      Skips the '\n' marked in the mask of 64 bytes, or finds the one that ends the skip.
+ *
+ * @param mask
+ *      Bit i is set when texts[base + i] is a '\n'.
+ *
+ * @param newlines
+ *      Number of bits set in mask.
+ *
+ * @return
+ *      Offset right after the last '\n' skipped once *lines reaches 0, otherwise 0.
+ */
+KERNEL_BODY size_t skipMask(unsigned long long mask, int newlines, size_t base, long long *lines){
+    if(newlines < *lines){
+        *lines -= newlines;
+        return 0;
+    }
+    while(--*lines) mask &= mask - 1;
+    return base + __builtin_ctzll(mask) + 1;
+}
+
+
+/**
+ * @brief
+ *      SSE2 newline kernel that scans 64 bytes per iteration.
+ *
+ * @note
+ *      See skipNewlines() for the parameters and the return value.
+ */
+__attribute__((target("sse2")))
+size_t skipNewlinesSSE2(const char *texts, size_t textsLen, long long *lines){
+    const __m128i newline = _mm_set1_epi8('\n');
+    size_t pos = 0, found;
+
+    for(; pos + 64 <= textsLen && *lines > 0; pos += 64){
+        unsigned long long mask = 0;
+        for(int part = 0; part < 4; part++){
+            __m128i block = _mm_loadu_si128((const __m128i *)(texts + pos + 16 * part));
+            mask |= (unsigned long long)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)) << (16 * part);
+        }
+        if(mask && (found = skipMask(mask, __builtin_popcountll(mask), pos, lines))) return found;
+    }
+
+    if(*lines <= 0) return pos;
+    return pos + skipNewlinesScalar(texts + pos, textsLen - pos, lines);
+}
+
+
+/**
+ * @brief
+ *      AVX2 newline kernel that scans 64 bytes per iteration.
+ *
+ * @note
+ *      See skipNewlines() for the parameters and the return value.
+ */
+__attribute__((target("avx2,popcnt")))
+size_t skipNewlinesAVX2(const char *texts, size_t textsLen, long long *lines){
+    const __m256i newline = _mm256_set1_epi8('\n');
+    size_t pos = 0, found;
+
+    for(; pos + 64 <= textsLen && *lines > 0; pos += 64){
+        unsigned int low = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(texts + pos)), newline)),
+            high = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(texts + pos + 32)), newline));
+        unsigned long long mask = (unsigned long long)high << 32 | low;
+        if(mask && (found = skipMask(mask, __builtin_popcountll(mask), pos, lines))) return found;
+    }
+
+    if(*lines <= 0) return pos;
+    return pos + skipNewlinesScalar(texts + pos, textsLen - pos, lines);
+}
+#endif
+
+
+/**
+ * @brief
+ *      Builds the nibble tables of a set of word characters.
+ *
+ * @param wordChars
+ *      Characters that belong to a word, one bool per byte.
+ *
+ * @param classes
+ *      WordClasses receiving the set.
+ */
+void buildWordClasses(const bool *wordChars, WordClasses *classes){
+    memset(classes, 0, sizeof(WordClasses));
+    for(int c = 0; c <= UCHAR_MAX; c++){
+        if(wordChars[c]) classes->rows[c >> 7][c & 15] |= 1 << ((c >> 4) & 7);
+    }
+}
+
+
+/**
+ * @brief
+ *      Chooses the mask kernels of the AffixScanner based on the instruction sets reported by CPUID.
+ *
+ * @param equalMask
+ *      Pointer that is set to the chosen equal mask kernel.
+ *
+ * @param wordMask
+ *      Pointer that is set to the chosen word mask kernel.
+ */
+void selectMaskKernels(ByteMaskKernel *equalMask, WordMaskKernel *wordMask){
+    *equalMask = equalMaskScalar;
+    *wordMask = wordMaskScalar;
+#ifdef X86_KERNELS
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")){
+        *equalMask = equalMaskAVX2;
+        *wordMask = wordMaskAVX2;
+    }
+#endif
+}
+
+
+/**
+ * @brief
+ *      Prepares an AffixScanner for a block.
+ *
+ * @param words
+ *      AffixScanner to be prepared.
+ *
+ * @param texts
+ *      Block of texts, which begins at the beginning of a word or at a character that is not part of one.
+ *
+ * @param textsLen
+ *      Number of characters in texts.
+ *
+ * @param affix
+ *      Prefix/suffix, made of 1 to AFFIX_SCAN_MAX word characters.
+ *
+ * @param affixLen
+ *      Number of characters in affix.
+ *
+ * @param suffix
+ *      Boolean value indicating whether the words must end with the affix rather than begin with it.
+ *
+ * @param fold
+ *      Boolean value indicating whether the affix is folded and matches the texts whatever their case.
+ *
+ * @param classes
+ *      Word characters (see buildWordClasses()).
+ */
+void initAffixScanner(AffixScanner *words, const char *texts, size_t textsLen, const char *affix, size_t affixLen,
+    bool suffix, bool fold, const WordClasses *classes){
+    initSearchKernel();
+    words->equalMask = selectedEqualMaskKernel;
+    words->wordMask = selectedWordMaskKernel;
+    words->classes = classes;
+    words->texts = texts;
+    words->textsLen = textsLen;
+    words->affix = affix;
+    words->affixLen = affixLen;
+    words->suffix = suffix;
+    words->fold = fold;
+    words->base = SIZE_MAX;
+}
+
+
+/**
+ * @brief
+ *      Obtains 64 bytes of a block from an offset on, which are copied (and padded with null characters) when they
+ *      reach past the end of the block, so the kernels never read past it.
+ */
+static const char *window(const AffixScanner *words, size_t offset, char *copy){
+    if(offset + 64 <= words->textsLen) return words->texts + offset;
+
+    memset(copy, 0, 64);
+    if(offset < words->textsLen) memcpy(copy, words->texts + offset, words->textsLen - offset);
+    return copy;
+}
+
+
+/**
+ * @brief
+ *      Finds the hits of the window of 64 bytes that begins at base: the offsets of the first byte of the affix
+ *      where the last byte of the affix is found as well, at the beginning of a word for a prefix and right before
+ *      the end of a word for a suffix.
+ *
+ * @note
+ *      The last byte of the affix is compared in the 64 bytes that begin affixLen - 1 bytes later, so its mask
+ *      lines up with that of the first byte, and the word characters after a suffix in the 64 bytes that begin
+ *      affixLen bytes later.
+ *
+ * @param words
+ *      AffixScanner of the block.
+ *
+ * @param base
+ *      Offset of the window, a multiple of 64.
+ */
+void loadAffixWindow(AffixScanner *words, size_t base){
+    size_t affixLen = words->affixLen;
+    char first = words->affix[0], last = words->affix[affixLen - 1], copy[64];
+
+    words->base = base;
+    words->hits = words->equalMask(window(words, base, copy), first, words->fold ? foldBit(first) : 0);
+    if(words->hits && affixLen > 1)
+        words->hits &= words->equalMask(window(words, base + affixLen - 1, copy), last, words->fold ? foldBit(last) : 0);
+    if(!words->hits) return;
+
+    if(words->suffix){
+        words->hits &= ~words->wordMask(window(words, base + affixLen, copy), words->classes);
+        return;
+    }
+
+    unsigned char before = base ? words->texts[base - 1] : 0;
+    bool wordBefore = base && (words->classes->rows[before >> 7][before & 15] >> ((before >> 4) & 7)) & 1;
+    words->hits &= ~(words->wordMask(window(words, base, copy), words->classes) << 1 | wordBefore);
+}
+
+
+/**
+ * @brief
+ *      Scalar equal mask kernel.
+ *
+ * @param texts
+ *      64 bytes to be compared.
+ *
+ * @param byte
+ *      Byte they are compared with.
+ *
+ * @param caseBit
+ *      Bits set in texts before they are compared, so both cases of a folded letter match it (see foldBit()).
+ *
+ * @return
+ *      Mask whose bit i is set when texts[i] | caseBit is byte.
+ */
+uint64_t equalMaskScalar(const char *texts, char byte, char caseBit){
+    uint64_t mask = 0;
+
+    for(int i = 0; i < 64; i++) mask |= (uint64_t)((texts[i] | caseBit) == byte) << i;
+    return mask;
+}
+
+
+/**
+ * @brief
+ *      Scalar word mask kernel, which looks every byte up in the nibble tables.
+ *
+ * @param texts
+ *      64 bytes to be classified.
+ *
+ * @param classes
+ *      Word characters (see buildWordClasses()).
+ *
+ * @return
+ *      Mask whose bit i is set when texts[i] is a word character.
+ */
+uint64_t wordMaskScalar(const char *texts, const WordClasses *classes){
+    uint64_t mask = 0;
+
+    for(int i = 0; i < 64; i++){
+        unsigned char c = texts[i];
+        mask |= (uint64_t)((classes->rows[c >> 7][c & 15] >> ((c >> 4) & 7)) & 1) << i;
+    }
+    return mask;
+}
+
+
+#ifdef X86_KERNELS
+/**
+ * @brief
+ *      AVX2 equal mask kernel.
+ *
+ * @note
+ *      See equalMaskScalar() for the parameters and the return value.
+ */
+__attribute__((target("avx2")))
+uint64_t equalMaskAVX2(const char *texts, char byte, char caseBit){
+    const __m256i bytes = _mm256_set1_epi8(byte), bits = _mm256_set1_epi8(caseBit);
+    unsigned int low = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_or_si256(_mm256_loadu_si256((const __m256i *)texts), bits), bytes)),
+        high = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_or_si256(_mm256_loadu_si256((const __m256i *)(texts + 32)), bits), bytes));
+    return (uint64_t)high << 32 | low;
+}
+
+
+/**
+ * @brief
+ *      AVX2 word mask kernel. The low nibble of every byte picks the row of both halves of the nibble tables, the
+ *      high bit of the byte picks the half, and the rest of its high nibble picks the bit of the row.
+ *
+ * @note
+ *      See wordMaskScalar() for the parameters and the return value.
+ */
+__attribute__((target("avx2")))
+uint64_t wordMaskAVX2(const char *texts, const WordClasses *classes){
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F), highBits = _mm256_set1_epi8(0x07),
+        rows0 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)classes->rows[0])),
+        rows1 = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)classes->rows[1])),
+        bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+            1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    uint64_t mask = 0;
+
+    for(int part = 0; part < 2; part++){
+        __m256i block = _mm256_loadu_si256((const __m256i *)(texts + 32 * part)),
+            low = _mm256_and_si256(block, lowNibble),
+            row = _mm256_blendv_epi8(_mm256_shuffle_epi8(rows0, low), _mm256_shuffle_epi8(rows1, low), block),
+            bit = _mm256_shuffle_epi8(bits, _mm256_and_si256(_mm256_srli_epi16(block, 4), highBits));
+        mask |= (uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit)) << (32 * part);
+    }
+    return mask;
+}
+#endif
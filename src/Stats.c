@@ -0,0 +1,122 @@
+/**
+ * @file Stats.c
+ *
+ * @brief
+ *      Adds up the counters of every context used by the program (--stats) and prints them at exit.
+ *
+ * @note
+ *      Every context counts on its own, without any lock or atomic (see fr_stats). Its counters are added to
+ *      the totals once it is done with an input (or a worker thread of the j flag is done with its chunks), so
+ *      the lock is taken once per file or thread. With -DNO_STATS nothing is counted, and only the elapsed time
+ *      and the bytes read are printed.
+ */
+#include "FindReplace.h"
+
+//Counters of all contexts of the program
+static fr_stats totalStats;
+#ifndef NO_STATS
+static pthread_mutex_t statsLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+
+/**
+ * @brief
+ *      Adds the counters of a part to a total.
+ *
+ * @param total
+ *      fr_stats receiving the counters.
+ *
+ * @param part
+ *      fr_stats to be added.
+ */
+void addStats(fr_stats *total, const fr_stats *part){
+    total->bytesScanned += part->bytesScanned;
+    total->bytesWritten += part->bytesWritten;
+    total->linesScanned += part->linesScanned;
+    total->linesInRange += part->linesInRange;
+    total->candidates += part->candidates;
+    total->matches += part->matches;
+    total->inputSeconds += part->inputSeconds;
+    total->outputSeconds += part->outputSeconds;
+}
+
+
+/**
+ * @brief
+ *      Adds the counters of a context (or a worker thread) to the totals of the program.
+ *
+ * @param stats
+ *      fr_stats to be added.
+ */
+void recordStats(const fr_stats *stats){
+#ifndef NO_STATS
+    pthread_mutex_lock(&statsLock);
+    addStats(&totalStats, stats);
+    pthread_mutex_unlock(&statsLock);
+#else
+    (void)stats;
+#endif
+}
+
+
+/**
+ * @brief
+ *      Prints the totals of the program, as text to stderr or as a JSON object to a file.
+ *
+ * @note
+ *      The search time is the elapsed time left once the input and output times are taken out, so it includes
+ *      the page faults of a memory-mapped input file. With the j flag, the output time is the time the main
+ *      thread spends writing the chunks.
+ *
+ * @param jsonPath
+ *      String indicating the JSON file, or NULL for stderr.
+ *
+ * @param inputPath
+ *      Name of the input path that was used ("mmap", "stream", etc.).
+ *
+ * @param bytesRead
+ *      Number of bytes read from the input files.
+ *
+ * @param seconds
+ *      Elapsed time of the find/replace function.
+ *
+ * @return
+ *      False if the JSON file couldn't be written.
+ */
+bool printStats(const char *jsonPath, const char *inputPath, size_t bytesRead, double seconds){
+    const fr_stats *stats = &totalStats;
+    double searchSeconds = seconds - stats->inputSeconds - stats->outputSeconds;
+#ifdef NO_STATS
+    bool counted = false;
+#else
+    bool counted = true;
+#endif
+
+    if(searchSeconds < 0) searchSeconds = 0;
+
+    if(!jsonPath){
+        fprintf(stderr, "stats: %s input, %zu bytes read in %.6f s\n", inputPath, bytesRead, seconds);
+        if(!counted){
+            fprintf(stderr, "stats: counters compiled out (-DNO_STATS)\n");
+            return true;
+        }
+        fprintf(stderr, "stats: %llu bytes scanned, %llu bytes written\n", stats->bytesScanned, stats->bytesWritten);
+        fprintf(stderr, "stats: %llu lines scanned, %llu lines in range\n", stats->linesScanned, stats->linesInRange);
+        fprintf(stderr, "stats: %llu candidates, %llu matches\n", stats->candidates, stats->matches);
+        fprintf(stderr, "stats: %.6f s input, %.6f s search, %.6f s output\n", stats->inputSeconds, searchSeconds,
+            stats->outputSeconds);
+        return true;
+    }
+
+    FILE *statsFile = fopen(jsonPath, "w");
+    if(!statsFile) return false;
+
+    fprintf(statsFile, "{\"inputPath\": \"%s\", \"counters\": %s, \"bytesRead\": %zu, ", inputPath,
+        counted ? "true" : "false", bytesRead);
+    fprintf(statsFile, "\"bytesScanned\": %llu, \"bytesWritten\": %llu, \"linesScanned\": %llu, \"linesInRange\": %llu, ",
+        stats->bytesScanned, stats->bytesWritten, stats->linesScanned, stats->linesInRange);
+    fprintf(statsFile, "\"candidates\": %llu, \"matches\": %llu, ", stats->candidates, stats->matches);
+    fprintf(statsFile, "\"inputSeconds\": %.6f, \"searchSeconds\": %.6f, \"outputSeconds\": %.6f, \"seconds\": %.6f}\n",
+        stats->inputSeconds, searchSeconds, stats->outputSeconds, seconds);
+    return !fclose(statsFile);
+}
@@ -0,0 +1,367 @@
+/**
+ * @file TreeWalk.c
+ *
+ * @brief
+ *      Edits every file under the directories of a batch in place on a pool of worker threads (R flag).
+ *
+ * @note
+ *      Every worker owns a deque of tasks. A task is either a directory to be read or a file to be edited.
+ *      A worker pushes what it discovers on its own deque and takes its next task from the same end, while an
+ *      idle worker steals from the other end of another worker's deque. So the files of a huge directory or
+ *      a single huge file never keep the other workers waiting. Each worker edits its files with its own
+ *      outputFile and context, so the write path never takes a lock shared with other workers.
+ */
+#include "FindReplace.h"
+#include <dirent.h>
+#include <fnmatch.h>
+#include <stdatomic.h>
+
+//Number of tasks a deque holds before it grows
+#define DEQUE_CAPACITY 64
+
+//Globs of the I and X flags
+GlobList includeGlobs, excludeGlobs;
+
+/*
+Task is a directory to be read or a file to be edited.
+discovered indicates the task was found while reading a directory, rather than entered by the user.
+*/
+typedef struct {
+    char *path;
+    bool directory, discovered;
+} Task;
+
+/*
+TaskDeque holds the tasks of a worker. Tasks in [head, tail) are waiting: the owner pushes and pops at
+tail, thieves steal at head.
+*/
+typedef struct {
+    Task *tasks;
+    size_t head, tail, capacity;
+    pthread_mutex_t lock;
+} TaskDeque;
+
+/*
+TreePool is shared by all workers of a walk. It is large, so it is static rather than on the stack.
+pending counts the tasks that are waiting or running, queued counts the tasks that are waiting.
+*/
+typedef struct {
+    const fr_pattern *pattern;
+    int workerCount, nextRoot;
+    TaskDeque deques[MAX_THREADS];
+    BatchSummary summaries[MAX_THREADS];
+    atomic_size_t pending, queued;
+    pthread_mutex_t idleLock;
+    pthread_cond_t workAdded;
+} TreePool;
+
+/*
+WorkerArgs tells a worker which deque is its own.
+*/
+typedef struct {
+    TreePool *pool;
+    int id;
+} WorkerArgs;
+
+
+/**
+ * @brief
+ *      Adds a glob to the list of the I or X flag.
+ *
+ * @return
+ *      False if the list couldn't grow.
+ */
+bool addGlob(GlobList *list, char *glob){
+    char **larger = realloc(list->globs, (list->count + 1) * sizeof(char *));
+    if(!larger) return false;
+
+    list->globs = larger;
+    list->globs[list->count++] = glob;
+    return true;
+}
+
+
+/**
+ * @brief
+ *      Checks if a discovered file or directory matches any glob of the list.
+ *
+ * @note
+ *      A glob that contains a '/' is matched against the whole path, otherwise against the name only.
+ *
+ * @param path
+ *      Path of the file or directory.
+ *
+ * @param name
+ *      Name of the file or directory (the end of path).
+ */
+static bool matchesGlob(const GlobList *list, const char *path, const char *name){
+    for(int i = 0; i < list->count; i++){
+        bool wholePath = strchr(list->globs[i], '/') != NULL;
+        if(!fnmatch(list->globs[i], wholePath ? path : name, wholePath ? FNM_PATHNAME : 0)) return true;
+    }
+    return false;
+}
+
+
+/**
+ * @brief
+ *      Pushes a task on the tail of a deque and wakes up an idle worker.
+ */
+static void pushTask(TreePool *pool, TaskDeque *deque, Task task){
+    atomic_fetch_add(&pool->pending, 1);
+
+    pthread_mutex_lock(&deque->lock);
+    //Moves the waiting tasks to the front before growing.
+    if(deque->tail == deque->capacity && deque->head){
+        memmove(deque->tasks, deque->tasks + deque->head, (deque->tail - deque->head) * sizeof(Task));
+        deque->tail -= deque->head;
+        deque->head = 0;
+    }
+    if(deque->tail == deque->capacity){
+        size_t capacity = deque->capacity ? deque->capacity * 2 : DEQUE_CAPACITY;
+        Task *larger = realloc(deque->tasks, capacity * sizeof(Task));
+        if(!larger){
+            pthread_mutex_unlock(&deque->lock);
+            fprintf(stderr, "%s: skipped, out of memory\n", task.path);
+            free(task.path);
+            atomic_fetch_sub(&pool->pending, 1);
+            return;
+        }
+        deque->tasks = larger;
+        deque->capacity = capacity;
+    }
+    deque->tasks[deque->tail++] = task;
+    pthread_mutex_unlock(&deque->lock);
+
+    atomic_fetch_add(&pool->queued, 1);
+    pthread_mutex_lock(&pool->idleLock);
+    pthread_cond_signal(&pool->workAdded);
+    pthread_mutex_unlock(&pool->idleLock);
+}
+
+
+/**
+ * @brief
+ *      Takes a task from a deque, from the tail for its owner or from the head for a thief.
+ *
+ * @return
+ *      False if the deque is empty.
+ */
+static bool takeTask(TreePool *pool, TaskDeque *deque, bool owner, Task *task){
+    bool taken = false;
+
+    pthread_mutex_lock(&deque->lock);
+    if(deque->head < deque->tail){
+        *task = owner ? deque->tasks[--deque->tail] : deque->tasks[deque->head++];
+        if(deque->head == deque->tail) deque->head = deque->tail = 0;
+        taken = true;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    if(taken) atomic_fetch_sub(&pool->queued, 1);
+    return taken;
+}
+
+
+/**
+ * @brief
+ *      Reads a directory and pushes a task for every regular file and directory in it.
+ *
+ * @note
+ *      All entries are read before any task is pushed, so the temporary files of the in-place edits of this
+ *      directory are never found. Symbolic links are only followed for the directories entered by the user.
+ */
+static void readDirectory(TreePool *pool, TaskDeque *deque, Task *task, BatchSummary *summary){
+    int directoryFd = openat(AT_FDCWD, task->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC | (task->discovered ? O_NOFOLLOW : 0));
+    DIR *directory = directoryFd < 0 ? NULL : fdopendir(directoryFd);
+    Task *found = NULL;
+    size_t foundCount = 0, foundCapacity = 0;
+    struct dirent *entry;
+    size_t pathLen = strlen(task->path);
+    bool endsWithSlash = pathLen && task->path[pathLen - 1] == '/';
+
+    if(!directory){
+        if(directoryFd >= 0) close(directoryFd);
+        recordBatchError(summary, task->path, INPUT_FILE_MISSING);
+        return;
+    }
+
+    while((entry = readdir(directory))){
+        const char *name = entry->d_name;
+        if(!strcmp(name, ".") || !strcmp(name, "..")) continue;
+
+        bool isDirectory = entry->d_type == DT_DIR, isFile = entry->d_type == DT_REG;
+        if(entry->d_type == DT_UNKNOWN){
+            struct stat entryStat;
+            if(fstatat(directoryFd, name, &entryStat, AT_SYMLINK_NOFOLLOW)) continue;
+            isDirectory = S_ISDIR(entryStat.st_mode);
+            isFile = S_ISREG(entryStat.st_mode);
+        }
+        if(!isDirectory && !isFile) continue;
+
+        char *path = NULL;
+        if(asprintf(&path, endsWithSlash ? "%s%s" : "%s/%s", task->path, name) < 0) continue;
+
+        bool excluded = matchesGlob(&excludeGlobs, path, name),
+            included = isDirectory || !includeGlobs.count || matchesGlob(&includeGlobs, path, name);
+        if(excluded || !included){
+            free(path);
+            continue;
+        }
+
+        if(foundCount == foundCapacity){
+            size_t capacity = foundCapacity ? foundCapacity * 2 : DEQUE_CAPACITY;
+            Task *larger = realloc(found, capacity * sizeof(Task));
+            if(!larger){
+                free(path);
+                break;
+            }
+            found = larger;
+            foundCapacity = capacity;
+        }
+        found[foundCount++] = (Task){.path = path, .directory = isDirectory, .discovered = true};
+    }
+    closedir(directory);
+
+    //Pushed in reverse, so the owner takes the entries in the order they were read.
+    while(foundCount) pushTask(pool, deque, found[--foundCount]);
+    free(found);
+}
+
+
+/**
+ * @brief
+ *      Worker thread that runs the tasks of its own deque and steals from the others when it runs out.
+ *
+ * @param arg
+ *      WorkerArgs of the worker.
+ *
+ * @return
+ *      NULL.
+ */
+static void *treeWorker(void *arg){
+    TreePool *pool = ((WorkerArgs *)arg)->pool;
+    int id = ((WorkerArgs *)arg)->id;
+    TaskDeque *own = pool->deques + id;
+    BatchSummary *summary = pool->summaries + id;
+    Task task;
+
+    while(true){
+        bool taken = takeTask(pool, own, true, &task);
+        for(int i = 1; !taken && i < pool->workerCount; i++)
+            taken = takeTask(pool, pool->deques + (id + i) % pool->workerCount, false, &task);
+
+        if(!taken){
+            pthread_mutex_lock(&pool->idleLock);
+            while(!atomic_load(&pool->queued) && atomic_load(&pool->pending))
+                pthread_cond_wait(&pool->workAdded, &pool->idleLock);
+            pthread_mutex_unlock(&pool->idleLock);
+
+            if(!atomic_load(&pool->pending)) break;
+            continue;
+        }
+
+        if(task.directory) readDirectory(pool, own, &task, summary);
+        else replaceBatchFile(task.path, pool->pattern, 1, task.discovered, summary);
+        free(task.path);
+
+        //The last task wakes up every idle worker so they can finish.
+        if(atomic_fetch_sub(&pool->pending, 1) == 1){
+            pthread_mutex_lock(&pool->idleLock);
+            pthread_cond_broadcast(&pool->workAdded);
+            pthread_mutex_unlock(&pool->idleLock);
+        }
+    }
+
+    releaseStreamBuffer();
+    return NULL;
+}
+
+
+/**
+ * @brief
+ *      Adds a file or directory entered by the user to the pool.
+ *
+ * @param path
+ *      String indicating the file or directory.
+ *
+ * @param context
+ *      TreePool receiving the task. Entered tasks are spread over the deques in turns.
+ */
+static void addRootTask(char *path, void *context){
+    TreePool *pool = context;
+    struct stat pathStat;
+    char *copy = strdup(path);
+
+    if(!copy) return;
+    pushTask(pool, pool->deques + pool->nextRoot++ % pool->workerCount,
+        (Task){.path = copy, .directory = !stat(path, &pathStat) && S_ISDIR(pathStat.st_mode)});
+}
+
+
+/**
+ * @brief
+ * Performs the corresponding find/replace function on every file under the entered files and directories,
+ * editing each one in place.
+ *
+ * @note
+ *      Files found in the directories are skipped when they look binary (see replaceBatchFile()), when
+ *      they don't match any glob of the I flag, or when they match a glob of the X flag. Directories that
+ *      match a glob of the X flag are not read.
+ *
+ * @param pattern
+ *      Compiled pattern of the search/replace function.
+ *
+ * @param paths
+ *      Array of the files and directories entered as command line arguments.
+ *
+ * @param pathCount
+ *      Number of paths.
+ *
+ * @param manifestPath
+ *      String indicating the manifest file (m flag), or NULL.
+ *
+ * @param workers
+ *      Number of worker threads.
+ *
+ * @param summary
+ *      BatchSummary that receives the results of all files.
+ */
+void walkTrees(const fr_pattern *pattern, char **paths, int pathCount, const char *manifestPath, int workers,
+    BatchSummary *summary){
+    static TreePool pool;
+    pthread_t threads[MAX_THREADS];
+    WorkerArgs args[MAX_THREADS];
+    int started = 0;
+
+    memset(&pool, 0, sizeof(pool));
+    pool.pattern = pattern;
+    pool.workerCount = workers;
+
+    for(int i = 0; i < workers; i++) pthread_mutex_init(&pool.deques[i].lock, NULL);
+    pthread_mutex_init(&pool.idleLock, NULL);
+    pthread_cond_init(&pool.workAdded, NULL);
+    initSearchKernel();
+
+    for(int i = 0; i < pathCount; i++) addRootTask(paths[i], &pool);
+    if(manifestPath && !readManifest(manifestPath, addRootTask, &pool)) recordBatchError(summary, manifestPath, INPUT_FILE_MISSING);
+
+    for(; started < workers; started++){
+        args[started] = (WorkerArgs){.pool = &pool, .id = started};
+        if(pthread_create(threads + started, NULL, treeWorker, args + started)) break;
+    }
+    //Without any worker thread, the calling thread runs all tasks by itself (it steals from every deque).
+    if(!started){
+        args[0] = (WorkerArgs){.pool = &pool, .id = 0};
+        treeWorker(args);
+    }
+    for(int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+
+    for(int i = 0; i < workers; i++){
+        mergeBatchSummary(summary, pool.summaries + i);
+        free(pool.deques[i].tasks);
+        pthread_mutex_destroy(&pool.deques[i].lock);
+    }
+    pthread_cond_destroy(&pool.workAdded);
+    pthread_mutex_destroy(&pool.idleLock);
+}
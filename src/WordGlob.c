@@ -0,0 +1,146 @@
+/**
+ * @file WordGlob.c
+ *
+ * @brief
+ *      Compiles the search text of the w flag when it is more than a prefix/suffix (ex. *ab*cd*, pre?ix*) into a
+ *      Shift-And automaton, which tells whether a whole word matches it in a single pass over the word.
+ *
+ * @note
+ *      The states of the glob are the bits of a word, so a word is matched without ever going back, whatever the
+ *      number of '*' in the glob. Words are the runs of the characters of SearchPlan::words, as with the
+ *      prefix/suffix modes.
+ * @note
+ *      The automaton reads bytes. In the UTF-8 mode, a character of the glob is an item per byte, and a '?' is
+ *      entered by the first byte of a character and stays set over its other bytes (see WordGlob::loops).
+ */
+#include "Engine.h"
+
+
+/**
+ * @brief
+ *      Checks if a search text of the w flag needs a glob, rather than the prefix/suffix find/replace functions.
+ *
+ * @param search
+ *      Search text, including its '*' and '?'.
+ *
+ * @return
+ *      False if the only wildcard of the search text is a '*' at its beginning or its end, otherwise true.
+ */
+bool isWordGlob(const char *search){
+    size_t searchLen = strlen(search), wildcards = 0;
+
+    for(size_t i = 0; i < searchLen; i++) wildcards += (search[i] == '*' || search[i] == '?');
+    return searchLen < 2 || wildcards != 1 || (search[0] != '*' && search[searchLen - 1] != '*');
+}
+
+
+/**
+ * @brief
+ *      Compiles a glob of the w flag.
+ *
+ * @note
+ *      Every character of the glob other than '*' and '?' must belong to a word, since a match is a whole word.
+ *
+ * @param glob
+ *      WordGlob receiving the glob.
+ *
+ * @param search
+ *      Search text of the glob.
+ *
+ * @param words
+ *      Characters that belong to a word (see SearchPlan).
+ *
+ * @param fold
+ *      Boolean value indicating whether the letters of the glob match both of their cases (i flag).
+ *
+ * @param literal
+ *      Pointer that is set to the longest run of plain characters of the glob (possibly empty), which every
+ *      matching word contains, so the words without it are never matched.
+ *
+ * @param literalLen
+ *      Pointer to the length of literal.
+ *
+ * @return
+ *      FR_WILDCARD_INVALID if the glob has no character other than '*', more than GLOB_MAX_ITEMS, or a character
+ *      that is not part of a word, FR_OUT_OF_MEMORY if literal couldn't be allocated, otherwise FR_OK.
+ */
+int compileWordGlob(WordGlob *glob, const char *search, const WordSet *words, bool fold, char **literal,
+    size_t *literalLen){
+    size_t searchLen = strlen(search), items = 0, runStart = 0, bestStart = 0, bestLen = 0;
+
+    memset(glob, 0, sizeof(WordGlob));
+    glob->floating = search[0] == '*';
+
+    for(size_t i = 0; i < searchLen; i++){
+        unsigned char c = search[i];
+
+        //Runs of plain characters are broken by the wildcards, and a '*' lets the item before it absorb any characters.
+        if(c == '*' || c == '?') runStart = i + 1;
+        if(c == '*'){
+            for(int b = 0; items && b <= UCHAR_MAX; b++) glob->loops[b] |= 1ULL << (items - 1);
+            continue;
+        }
+
+        //A '?' begins with a word byte or the first byte of a UTF-8 character, and keeps the rest of the character.
+        if(c == '?'){
+            if(items == GLOB_MAX_ITEMS) return FR_WILDCARD_INVALID;
+            for(int b = 0; b <= UCHAR_MAX; b++){
+                if(words->bytes[b] || (words->utf8 && b >= 0xC2 && b <= 0xF4)) glob->masks[b] |= 1ULL << items;
+                if(words->utf8 && (b & 0xC0) == 0x80) glob->loops[b] |= 1ULL << items;
+            }
+            items++;
+            continue;
+        }
+
+        size_t charLen = wordCharAt(words, search, searchLen, i);
+        if(!charLen || items + charLen > GLOB_MAX_ITEMS) return FR_WILDCARD_INVALID;
+        for(size_t k = 0; k < charLen; k++, items++){
+            unsigned char byte = search[i + k];
+            glob->masks[byte] |= 1ULL << items;
+            if(fold) glob->masks[byte ^ foldBit(foldByte(byte))] |= 1ULL << items;
+        }
+        i += charLen - 1;
+
+        if(i + 1 - runStart > bestLen){
+            bestStart = runStart;
+            bestLen = i + 1 - runStart;
+        }
+    }
+    if(!items) return FR_WILDCARD_INVALID;
+
+    glob->accept = 1ULL << (items - 1);
+    if(!(*literal = strndup(search + bestStart, bestLen))) return FR_OUT_OF_MEMORY;
+    *literalLen = bestLen;
+    return FR_OK;
+}
+
+
+/**
+ * @brief
+ *      Checks if a whole word matches a glob.
+ *
+ * @param glob
+ *      Compiled glob.
+ *
+ * @param word
+ *      Word, made only of characters that belong to a word.
+ *
+ * @param wordLen
+ *      Length or number of characters in word.
+ *
+ * @return
+ *      True if the word matches the glob.
+ */
+bool matchWordGlob(const WordGlob *glob, const char *word, size_t wordLen){
+    uint64_t state = 0, start = 1;
+
+    for(size_t i = 0; i < wordLen; i++){
+        unsigned char byte = word[i];
+        state = (((state << 1) | start) & glob->masks[byte]) | (state & glob->loops[byte]);
+        start = glob->floating;
+
+        //Without a leading '*', the glob can't match once no item is left.
+        if(!state && !start) return false;
+    }
+    return state & glob->accept;
+}
@@ -154,7 +154,7 @@ Test(base_output, simple_search11, .description="Perform a simple replacement ov
 Test(base_output, simple_search12, .description="Search_text = Replacement_text") {
     char *test_name = "simple_search12";
     prep_files("turing.txt", test_name);    
-    sprintf(args, "-l 1,1000 -s the -j iansainsna ansanksnsn -r the %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    sprintf(args, "-l 1,1000 -s the -p iansainsna ansanksnsn -r the %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
     run_using_system_no_valgrind(test_name, args);
     expect_outfile_matches(test_name);
 }
@@ -410,6 +410,402 @@ Test(base_output, wildcard_search29, .description="Test ha* in ha.txt") {
     expect_outfile_matches(test_name);
 }
 
+Test(base_output, simple_search15, .description="Perform a simple replacement in lines longer than a block of the old line buffer. Line numbers still count real lines.") {
+    char *test_name = "simple_search15";
+    prep_files("longline.txt", test_name);    
+    sprintf(args, "-s machine -r device -l 2,3 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, wildcard_search30, .description="Perform a wildcard suffix replacement in a single line with thousands of characters.") {
+    char *test_name = "wildcard_search30";
+    prep_files("longline.txt", test_name);    
+    sprintf(args, "-w -s *ine -r ENGINE -l 2,2 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, simple_search16, .description="Perform a simple replacement over entire file and report the throughput. The output is not affected.") {
+    char *test_name = "simple_search16";
+    prep_files("unix.txt", test_name);    
+    sprintf(args, "-t -s the -r WOLFIE %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, simple_search17, .description="Perform a simple replacement within the range with four threads. The output matches the single-threaded run.") {
+    char *test_name = "simple_search17";
+    prep_files("unix.txt", test_name);    
+    sprintf(args, "-j 4 -s early -r \"WELL TIMED\" -l 11,23 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, wildcard_search31, .description="Perform a wildcard suffix replacement over entire file with two threads.") {
+    char *test_name = "wildcard_search31";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-s *ring -w -r TURING -j 2 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, wildcard_search32, .description="Perform a wildcard glob replacement over entire file. Search text has a * in the middle of the word.") {
+    char *test_name = "wildcard_search32";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-w -s '*in*e*' -r GLOB %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, wildcard_search33, .description="Perform a wildcard glob replacement within the range. Search text has ? and no plain character longer than one.") {
+    char *test_name = "wildcard_search33";
+    prep_files("unix.txt", test_name);    
+    sprintf(args, "-s '?a?e*' -w -r WORD -l 5,40 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, wildcard_search34, .description="Perform prefix replacement over entire file. Prefix is a single letter.") {
+    char *test_name = "wildcard_search34";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-w -s 't*' -r PREFIX %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, wildcard_search35, .description="Perform suffix replacement within the range. Suffix is a single letter.") {
+    char *test_name = "wildcard_search35";
+    prep_files("unix.txt", test_name);    
+    sprintf(args, "-s '*s' -w -r SUFFIX -l 3,30 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, multi_search01, .description="Apply the rules of a rules file over entire file.") {
+    char *test_name = "multi_search01";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-f tests.in.orig/rules01.txt %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, multi_search02, .description="Apply prefix/suffix rules of a rules file over entire file.") {
+    char *test_name = "multi_search02";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-w -f tests.in.orig/rules02.txt %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, multi_search03, .description="Apply the rules of a rules file together with the s/r pair within the range.") {
+    char *test_name = "multi_search03";
+    prep_files("unix.txt", test_name);    
+    sprintf(args, "-f tests.in.orig/rules01.txt -s early -r \"WELL TIMED\" -l 11,23 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, in_place01, .description="Edit the file in place. Terms have the same length.") {
+    char *test_name = "in_place01";
+    char cmd[200];
+    sprintf(cmd, "cp %s/unix.txt %s/%s.out.txt", TEST_ORIG_DIR, TEST_OUTPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-s the -r end %s/%s.out.txt %s/%s.out.txt", TEST_OUTPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, in_place02, .description="Edit the file in place. Terms have different lengths.") {
+    char *test_name = "in_place02";
+    char cmd[200];
+    sprintf(cmd, "cp %s/unix.txt %s/%s.out.txt", TEST_ORIG_DIR, TEST_OUTPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-s the -r WOLFIE %s/%s.out.txt %s/%s.out.txt", TEST_OUTPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, in_place03, .description="Edit the file in place with a wildcard prefix replacement in a single line.") {
+    char *test_name = "in_place03";
+    char cmd[200];
+    sprintf(cmd, "cp %s/turing.txt %s/%s.out.txt", TEST_ORIG_DIR, TEST_OUTPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-s mac* -r device -w -l 23,23 %s/%s.out.txt %s/%s.out.txt", TEST_OUTPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, batch_search01, .description="Edit a batch of files in place. Files that are missing are skipped.") {
+    char *test_name = "batch_search01";
+    char cmd[200];
+    sprintf(cmd, "cp %s/unix.txt %s/%s.out.txt", TEST_ORIG_DIR, TEST_OUTPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-b -s the -r WOLFIE %s/%s.missing.txt %s/%s.out.txt", TEST_OUTPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, INPUT_FILE_MISSING);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, recursive_search01, .description="Edit the files of a directory in place. Only the files matching the include glob are edited.") {
+    char *test_name = "recursive_search01";
+    char cmd[200];
+    sprintf(cmd, "cp %s/unix.txt %s/%s.out.txt", TEST_ORIG_DIR, TEST_OUTPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-R -j 2 -s the -r WOLFIE -I %s.out.txt %s", test_name, TEST_OUTPUT_DIR);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, standard_streams01, .description="Read the input from stdin and print the output to stdout.") {
+    char *test_name = "standard_streams01";
+    prep_files("unix.txt", test_name);
+    sprintf(args, "-s the -r WOLFIE - - < %s/%s.in.txt | tee %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, standard_streams02, .description="Read the input from stdin with a wildcard prefix replacement.") {
+    char *test_name = "standard_streams02";
+    prep_files("turing.txt", test_name);
+    sprintf(args, "-s mac* -r device -w - %s/%s.out.txt < %s/%s.in.txt", TEST_OUTPUT_DIR, test_name, TEST_INPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, compressed_input01, .description="Read a gzip compressed input file.") {
+    char *test_name = "compressed_input01";
+    char cmd[200];
+    sprintf(cmd, "gzip -c %s/unix.txt > %s/%s.in.gz", TEST_ORIG_DIR, TEST_INPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-s the -r WOLFIE %s/%s.in.gz %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, compressed_output01, .description="Write a gzip compressed output file, named *.gz.") {
+    char *test_name = "compressed_output01";
+    prep_files("unix.txt", test_name);
+    sprintf(args, "-s the -r WOLFIE %s/%s.in.txt %s/%s.out.txt.gz && gzip -df %s/%s.out.txt.gz", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, equal_length01, .description="Overwrite an equal-length replacement over the input read from stdin.") {
+    char *test_name = "equal_length01";
+    prep_files("turing.txt", test_name);
+    sprintf(args, "-s Manchester -r MANCHESTER - %s/%s.out.txt < %s/%s.in.txt", TEST_OUTPUT_DIR, test_name, TEST_INPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, line_index01, .description="Replace a line range through a line index, once when it is built and once when it is reused.") {
+    char *test_name = "line_index01";
+    char cmd[200];
+    prep_files("turing.txt", test_name);
+    sprintf(cmd, "./bin/FindReplace -x -s machine -r device -l 23,23 %s/%s.in.txt /dev/null", TEST_INPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-x -s machine -r device -l 23,23 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, stats01, .description="Write the counters of the engine to a JSON file without changing the output.") {
+    char *test_name = "stats01";
+    char cmd[200];
+    prep_files("turing.txt", test_name);
+    sprintf(args, "--stats=%s/%s.json -s machine -r device -l 23,23 %s/%s.in.txt %s/%s.out.txt", TEST_OUTPUT_DIR, test_name, TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+    sprintf(cmd, "grep -q '\"linesInRange\": 1,' %s/%s.json", TEST_OUTPUT_DIR, test_name);
+    cr_assert_eq(system(cmd), 0, "The JSON file doesn't count the line in range");
+}
+
+Test(base_output, long_pattern01, .description="Replace a search text long enough for the Two-Way search.") {
+    char *test_name = "long_pattern01";
+    prep_files("turing.txt", test_name);
+    sprintf(args, "-s 'considered to be the father of theoretical' -r 'seen as the father of theoretical' %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, regex01, .description="Replace the matches of a regex with its groups swapped.") {
+    char *test_name = "regex01";
+    prep_files("turing.txt", test_name);
+    sprintf(args, "-E -s '([0-9]+) ([A-Z][a-z]+) ([0-9]{4})' -r '\\2 \\1, \\3' %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, ignore_case01, .description="Replace a search text whatever its case over entire file.") {
+    char *test_name = "ignore_case01";
+    prep_files("turing.txt", test_name);
+    sprintf(args, "-i -s the -r THE %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, ignore_case02, .description="Perform prefix replacement whatever the case of the prefix.") {
+    char *test_name = "ignore_case02";
+    prep_files("turing.txt", test_name);
+    sprintf(args, "-w -s 'COMPUT*' -r COMPUTE -i %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, ignore_case03, .description="Replace the matches of a regex whatever their case.") {
+    char *test_name = "ignore_case03";
+    prep_files("turing.txt", test_name);
+    sprintf(args, "-i -E -s 'turing machines?' -r TM %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, utf8_words01, .description="Perform suffix replacement on UTF-8 words.") {
+    char *test_name = "utf8_words01";
+    prep_files("unicode.txt", test_name);
+    sprintf(args, "-u -w -s '*e' -r SUFFIX %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+Test(base_output, utf8_words02, .description="Replace the UTF-8 words that match a glob, whose ? stands for a character.") {
+    char *test_name = "utf8_words02";
+    prep_files("unicode.txt", test_name);
+    sprintf(args, "-u -w -s '?a?ve*' -r GLOB %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+}
+
+/* Library API: the output of the library must match the output of the program. */
+typedef struct {
+    char *texts;
+    size_t len;
+} memory_output;
+
+static bool write_to_memory(const char *texts, size_t textsLen, void *user) {
+    memory_output *output = user;
+    char *larger = realloc(output->texts, output->len + textsLen + 1);
+    if(!larger) return false;
+    memcpy(larger + output->len, texts, textsLen);
+    output->texts = larger;
+    output->len += textsLen;
+    return true;
+}
+
+static char *read_file(char *path, size_t *len) {
+    FILE *file = fopen(path, "rb");
+    cr_assert_not_null(file, "Couldn't open %s.\n", path);
+    fseek(file, 0, SEEK_END);
+    *len = ftell(file);
+    rewind(file);
+
+    char *texts = malloc(*len + 1);
+    cr_assert_eq(fread(texts, 1, *len, file), *len, "Couldn't read %s.\n", path);
+    fclose(file);
+    return texts;
+}
+
+/*
+Feeds the input of a test to fr_apply_buffer() whole, then in pieces of 1, 2, 3, 7 and 64 bytes (which end inside
+matches, words and lines), and checks every output and count of matches against those of the program.
+*/
+static void expect_buffers_match(char *test_name, const fr_options *options) {
+    size_t pieceLens[] = {0, 1, 2, 3, 7, 64}, inputLen, expectedLen;
+    char path[100];
+    fr_pattern *pattern;
+    fr_stats whole = {0};
+
+    sprintf(path, "%s/%s.in.txt", TEST_INPUT_DIR, test_name);
+    char *input = read_file(path, &inputLen);
+    sprintf(path, "%s/%s.out.txt", TEST_OUTPUT_DIR, test_name);
+    char *expected = read_file(path, &expectedLen);
+    cr_assert_eq(fr_compile(options, &pattern), FR_OK, "The pattern didn't compile.\n");
+
+    for(size_t p = 0; p < sizeof(pieceLens) / sizeof(pieceLens[0]); p++) {
+        size_t pieceLen = pieceLens[p] ? pieceLens[p] : inputLen;
+        memory_output output = {NULL, 0};
+        fr_context *context = fr_context_new(pattern, write_to_memory, &output);
+        fr_stats stats;
+        cr_assert_not_null(context);
+
+        for(size_t pos = 0; pos < inputLen; pos += pieceLen) {
+            size_t len = inputLen - pos < pieceLen ? inputLen - pos : pieceLen;
+            cr_assert_eq(fr_apply_buffer(context, input + pos, len, pos + len == inputLen), FR_OK);
+        }
+        fr_context_stats(context, &stats);
+        if(!pieceLens[p]) whole = stats;
+
+        cr_expect(output.len == expectedLen && !memcmp(output.texts, expected, expectedLen),
+            "The output of buffers of %zu bytes differs from the output of the program.\n", pieceLen);
+        cr_expect_eq(stats.matches, whole.matches, "Buffers of %zu bytes replaced %llu matches instead of %llu.\n",
+            pieceLen, stats.matches, whole.matches);
+        cr_expect_eq(stats.linesInRange, whole.linesInRange);
+        fr_context_free(context);
+        free(output.texts);
+    }
+    fr_free(pattern);
+    free(expected);
+    free(input);
+}
+
+TestSuite(library, .timeout=TEST_TIMEOUT);
+
+Test(library, apply_buffer01, .description="Perform suffix replacement within a range on buffers split anywhere.") {
+    char *test_name = "apply_buffer01";
+    prep_files("turing.txt", test_name);
+    sprintf(args, "-w -s '*ring' -r TURING -l 2,40 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+
+    fr_options options = {.search = "*ring", .replace = "TURING", .wildcard = true, .lineRange = true, .startLine = 2, .endLine = 40};
+    expect_buffers_match(test_name, &options);
+}
+
+Test(library, apply_buffer02, .description="Replace the matches of a regex on buffers split anywhere.") {
+    char *test_name = "apply_buffer02";
+    prep_files("turing.txt", test_name);
+    sprintf(args, "-i -E -s 'turing machines?' -r TM %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+
+    fr_options options = {.search = "turing machines?", .replace = "TM", .regex = true, .ignoreCase = true};
+    expect_buffers_match(test_name, &options);
+}
+
+Test(library, apply_buffer03, .description="Perform suffix replacement on UTF-8 words, on buffers that split characters.") {
+    char *test_name = "apply_buffer03";
+    prep_files("unicode.txt", test_name);
+    sprintf(args, "-u -w -s '*e' -r SUFFIX %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    run_using_system_no_valgrind(test_name, args);
+    expect_outfile_matches(test_name);
+
+    fr_options options = {.search = "*e", .replace = "SUFFIX", .wildcard = true, .utf8 = true};
+    expect_buffers_match(test_name, &options);
+}
+
+Test(library, apply_stream01, .description="Perform a simple replacement over a whole stream.") {
+    char *test_name = "apply_stream01";
+    char path[100];
+    fr_pattern *pattern;
+    size_t bytesRead;
+    prep_files("turing.txt", test_name);
+
+    fr_options options = {.search = "machine", .replace = "device"};
+    cr_assert_eq(fr_compile(&options, &pattern), FR_OK, "The pattern didn't compile.\n");
+    sprintf(path, "%s/%s.in.txt", TEST_INPUT_DIR, test_name);
+    FILE *input = fopen(path, "r");
+    sprintf(path, "%s/%s.out.txt", TEST_OUTPUT_DIR, test_name);
+    FILE *output = fopen(path, "w");
+    cr_assert(input && output);
+
+    cr_expect_eq(fr_apply_stream(pattern, input, output, &bytesRead), FR_OK);
+    cr_expect_gt(bytesRead, 0);
+    fclose(input);
+    fclose(output);
+    fr_free(pattern);
+    expect_outfile_matches(test_name);
+}
 
 /* Check memory usage. */
 Test(base_valgrind, simple_search01) {
@@ -489,7 +885,7 @@ Test(base_valgrind, simple_search11) {
 Test(base_valgrind, simple_search12) {
     char *test_name = "simple_search12";
     prep_files("turing.txt", test_name);    
-    sprintf(args, "-l 1,1000 -s the -j iansainsna ansanksnsn -r the %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    sprintf(args, "-l 1,1000 -s the -p iansainsna ansanksnsn -r the %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
     expect_no_valgrind_errors(run_using_system(test_name, args));
 }
 
@@ -711,6 +1107,130 @@ Test(base_valgrind, wildcard_search29) {
     expect_no_valgrind_errors(run_using_system(test_name, args));
 }
 
+Test(base_valgrind, simple_search15) {
+    char *test_name = "simple_search15";
+    prep_files("longline.txt", test_name);    
+    sprintf(args, "-s machine -r device -l 2,3 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, wildcard_search30) {
+    char *test_name = "wildcard_search30";
+    prep_files("longline.txt", test_name);    
+    sprintf(args, "-w -s *ine -r ENGINE -l 2,2 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, simple_search16) {
+    char *test_name = "simple_search16";
+    prep_files("unix.txt", test_name);    
+    sprintf(args, "-t -s the -r WOLFIE %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, simple_search17) {
+    char *test_name = "simple_search17";
+    prep_files("unix.txt", test_name);    
+    sprintf(args, "-j 4 -s early -r \"WELL TIMED\" -l 11,23 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, wildcard_search31) {
+    char *test_name = "wildcard_search31";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-s *ring -w -r TURING -j 2 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, multi_search01) {
+    char *test_name = "multi_search01";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-f tests.in.orig/rules01.txt %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, multi_search02) {
+    char *test_name = "multi_search02";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-w -f tests.in.orig/rules02.txt %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, multi_search03) {
+    char *test_name = "multi_search03";
+    prep_files("unix.txt", test_name);    
+    sprintf(args, "-f tests.in.orig/rules01.txt -s early -r \"WELL TIMED\" -l 11,23 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, in_place01) {
+    char *test_name = "in_place01";
+    char cmd[200];
+    sprintf(cmd, "cp %s/unix.txt %s/%s.out.txt", TEST_ORIG_DIR, TEST_OUTPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-s the -r end %s/%s.out.txt %s/%s.out.txt", TEST_OUTPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, in_place02) {
+    char *test_name = "in_place02";
+    char cmd[200];
+    sprintf(cmd, "cp %s/unix.txt %s/%s.out.txt", TEST_ORIG_DIR, TEST_OUTPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-s the -r WOLFIE %s/%s.out.txt %s/%s.out.txt", TEST_OUTPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, in_place03) {
+    char *test_name = "in_place03";
+    char cmd[200];
+    sprintf(cmd, "cp %s/turing.txt %s/%s.out.txt", TEST_ORIG_DIR, TEST_OUTPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-s mac* -r device -w -l 23,23 %s/%s.out.txt %s/%s.out.txt", TEST_OUTPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, batch_search01) {
+    char *test_name = "batch_search01";
+    char cmd[200];
+    sprintf(cmd, "cp %s/unix.txt %s/%s.out.txt", TEST_ORIG_DIR, TEST_OUTPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-b -s the -r WOLFIE %s/%s.missing.txt %s/%s.out.txt", TEST_OUTPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, recursive_search01) {
+    char *test_name = "recursive_search01";
+    char cmd[200];
+    sprintf(cmd, "cp %s/unix.txt %s/%s.out.txt", TEST_ORIG_DIR, TEST_OUTPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-R -j 2 -s the -r WOLFIE -I %s.out.txt %s", test_name, TEST_OUTPUT_DIR);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, compressed_input01) {
+    char *test_name = "compressed_input01";
+    char cmd[200];
+    sprintf(cmd, "gzip -c %s/unix.txt > %s/%s.in.gz", TEST_ORIG_DIR, TEST_INPUT_DIR, test_name);
+    system(cmd);
+    sprintf(args, "-s the -r WOLFIE %s/%s.in.gz %s/%s.out.txt.gz", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, standard_streams02) {
+    char *test_name = "standard_streams02";
+    prep_files("turing.txt", test_name);
+    sprintf(args, "-s mac* -r device -w - %s/%s.out.txt < %s/%s.in.txt", TEST_OUTPUT_DIR, test_name, TEST_INPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
+Test(base_valgrind, equal_length01) {
+    char *test_name = "equal_length01";
+    prep_files("turing.txt", test_name);
+    sprintf(args, "-s Manchester -r MANCHESTER - %s/%s.out.txt < %s/%s.in.txt", TEST_OUTPUT_DIR, test_name, TEST_INPUT_DIR, test_name);
+    expect_no_valgrind_errors(run_using_system(test_name, args));
+}
+
 
 /* Tests for invalid arguments. */
 
@@ -735,6 +1255,12 @@ Test(base_invalid_args, args_missing03, .description="Argument missing.") {
     int status = run_using_system_no_valgrind(test_name, args);
     expect_error_exit(status, MISSING_ARGUMENT);
 }
+Test(base_invalid_args, args_missing04, .description="Argument missing. No files for the batch.") {
+    char *test_name = "args_missing04";
+    sprintf(args, "-b -s the -r end -l 1,2");
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, MISSING_ARGUMENT);
+}
 
 
 //Duplicate arguments
@@ -778,6 +1304,14 @@ Test(base_invalid_args, duplicate_argument05, .description="Duplicate argument."
     expect_error_exit(status, DUPLICATE_ARGUMENT);
 }
 
+Test(base_invalid_args, duplicate_argument06, .description="Duplicate argument.") {
+    char *test_name = "duplicate_argument06";
+    prep_files("unix.txt", test_name);    
+    sprintf(args, "-i -s the -r end -u -i %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, DUPLICATE_ARGUMENT);
+}
+
 
 //Missing input file
 Test(base_invalid_args, input_file_missing, .description="Input file is missing.") {
@@ -787,6 +1321,13 @@ Test(base_invalid_args, input_file_missing, .description="Input file is missing.
     expect_error_exit(status, INPUT_FILE_MISSING);
 }
 
+Test(base_invalid_args, input_read_failed01, .description="Input file can't be read (it is a directory).") {
+    char *test_name = "input_read_failed01";
+    sprintf(args, "-s the -r end %s %s/%s.out.txt", TEST_ORIG_DIR, TEST_OUTPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, INPUT_READ_FAILED);
+}
+
 
 //Error with output file
 Test(base_invalid_args, output_file_unwritable01, .description="Output file is unwritable.") {
@@ -808,6 +1349,22 @@ Test(base_invalid_args, output_file_unwritable02, .description="Output file is u
     expect_error_exit(status, OUTPUT_FILE_UNWRITABLE);
 }
 
+Test(base_invalid_args, output_write_failed01, .description="Output device is full.") {
+    char *test_name = "output_write_failed01";
+    prep_files("unix.txt", test_name);
+    sprintf(args, "-s the -r WOLFIE %s/%s.in.txt /dev/full", TEST_INPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, OUTPUT_WRITE_FAILED);
+}
+
+Test(base_invalid_args, output_write_failed02, .description="Output device is full. Input is read through a pipe.") {
+    char *test_name = "output_write_failed02";
+    prep_files("unix.txt", test_name);
+    sprintf(args, "-s the -r WOLFIE /dev/stdin /dev/full < %s/%s.in.txt", TEST_INPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, OUTPUT_WRITE_FAILED);
+}
+
 
 //Missing -s flag or -s argument
 Test(base_invalid_args, s_argument_missing01, .description="-s option is missing.") {
@@ -842,6 +1399,14 @@ Test(base_invalid_args, s_argument_missing04, .description="-s argument is missi
     expect_error_exit(status, S_ARGUMENT_MISSING);
 }
 
+Test(base_invalid_args, s_argument_missing05, .description="-s argument is just * without the w flag") {
+    char *test_name = "s_argument_missing05";
+    prep_files("unix.txt", test_name);
+    sprintf(args, "-s '*' -r end %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, S_ARGUMENT_MISSING);
+}
+
 
 //Missing -r flag or -r argument
 Test(base_invalid_args, r_argument_missing01, .description="-r option is missing.") {
@@ -877,6 +1442,23 @@ Test(base_invalid_args, r_argument_missing04, .description="-r argument is missi
 }
 
 
+//Invalid rules file
+Test(base_invalid_args, rules_file_invalid01, .description="Rules file doesn't exist.") {
+    char *test_name = "rules_file_invalid01";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-f tests.in.orig/no_such_rules.txt %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, RULES_FILE_INVALID);
+}
+
+Test(base_invalid_args, rules_file_invalid02, .description="Rules file has a line without a tab.") {
+    char *test_name = "rules_file_invalid02";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-f tests.in.orig/rules03.txt -l 2,5 %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, RULES_FILE_INVALID);
+}
+
 //Missing -l argument or invalid -l argument
 Test(base_invalid_args, l_argument_invalid01, .description="l argument is invalid. Negative line number.") {
     char *test_name = "l_argument_invalid01";
@@ -911,11 +1493,37 @@ Test(base_invalid_args, l_argument_invalid04, .description="l argument is invali
 }
 
 
+//Invalid -j argument
+Test(base_invalid_args, j_argument_invalid01, .description="j argument is invalid. Not a number.") {
+    char *test_name = "j_argument_invalid01";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-s the -r NET -j abc %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, J_ARGUMENT_INVALID);
+}
+
+Test(base_invalid_args, j_argument_invalid02, .description="j argument is invalid. Zero threads.") {
+    char *test_name = "j_argument_invalid02";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-j 0 -s the -r NET %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, J_ARGUMENT_INVALID);
+}
+
+Test(base_invalid_args, j_argument_invalid03, .description="j argument is invalid. Number followed by letters.") {
+    char *test_name = "j_argument_invalid03";
+    prep_files("turing.txt", test_name);    
+    sprintf(args, "-s the -j 4x -r NET %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, J_ARGUMENT_INVALID);
+}
+
+
 //Invalid prefix/suffix
-Test(base_invalid_args, wildcard_invalid01, .description="Search text is not properly formatted.") {
+Test(base_invalid_args, wildcard_invalid01, .description="Search text is not properly formatted. Glob has a punctuation mark.") {
     char *test_name = "wildcard_invalid01";
     prep_files("unix.txt", test_name);    
-    sprintf(args, "-s *hello* -r HELLO -w %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    sprintf(args, "-s *hel-lo* -r HELLO -w %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
     int status = run_using_system_no_valgrind(test_name, args);
     expect_error_exit(status, WILDCARD_INVALID);
 }
@@ -934,4 +1542,13 @@ Test(base_invalid_args, wildcard_invalid03, .description="Search text is just *"
     sprintf(args, "-s * -r BOT -w %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
     int status = run_using_system_no_valgrind(test_name, args);
     expect_error_exit(status, WILDCARD_INVALID);
+}
+
+//Invalid regex
+Test(base_invalid_args, regex_invalid01, .description="Regex has a group without its ')'.") {
+    char *test_name = "regex_invalid01";
+    prep_files("unix.txt", test_name);    
+    sprintf(args, "-E -s 'a(b' -r X %s/%s.in.txt %s/%s.out.txt", TEST_INPUT_DIR, test_name, TEST_OUTPUT_DIR, test_name);
+    int status = run_using_system_no_valgrind(test_name, args);
+    expect_error_exit(status, REGEX_INVALID);
 }
\ No newline at end of file